@@ -3,6 +3,9 @@
 /* Defined when the --enable-api-exceptions configure argument was given */
 #cmakedefine CAIROMM_EXCEPTIONS_ENABLED 1
 
+/* Defined when the --enable-intrusive-refptr configure argument was given */
+#cmakedefine CAIROMM_INTRUSIVE_REFPTR 1
+
 /* Major version number of cairomm. */
 #cmakedefine CAIROMM_MAJOR_VERSION @CAIROMM_MAJOR_VERSION@
 
@@ -18,3 +18,23 @@ AC_DEFUN([CAIROMM_ARG_ENABLE_API_EXCEPTIONS],
   fi
 ])
 
+## CAIROMM_ARG_ENABLE_INTRUSIVE_REFPTR()
+##
+## Provide the --enable-intrusive-refptr configure argument, disabled
+## by default.
+##
+AC_DEFUN([CAIROMM_ARG_ENABLE_INTRUSIVE_REFPTR],
+[
+  AC_ARG_ENABLE([intrusive-refptr],
+      [  --enable-intrusive-refptr  Use the cairo reference count in RefPtr
+                              instead of std::shared_ptr. Changes the ABI.
+                              [[default=no]]],
+      [cairomm_enable_intrusive_refptr="$enableval"],
+      [cairomm_enable_intrusive_refptr='no'])
+
+  if test "x$cairomm_enable_intrusive_refptr" = "xyes"; then
+  {
+    AC_DEFINE([CAIROMM_INTRUSIVE_REFPTR],[1], [Defined when the --enable-intrusive-refptr configure argument was given])
+  }
+  fi
+])
@@ -33,17 +33,21 @@
 
 #include <cairommconfig.h>
 #include <cairomm/context.h>
+#include <cairomm/context_pool.h>
 #include <cairomm/device.h>
 #include <cairomm/enums.h>
 #include <cairomm/exception.h>
+#include <cairomm/fontcache.h>
 #include <cairomm/fontface.h>
 #include <cairomm/fontoptions.h>
+#include <cairomm/image_surface_pool.h>
 #include <cairomm/matrix.h>
 #include <cairomm/path.h>
 #include <cairomm/pattern.h>
 #include <cairomm/region.h>
 #include <cairomm/scaledfont.h>
 #include <cairomm/surface.h>
+#include <cairomm/tiled_surface.h>
 
 #endif //__CAIROMM_H
 
@@ -37,6 +37,39 @@ using namespace Cairo::Private;
 namespace Cairo
 {
 
+namespace
+{
+
+//Destroys the list returned by cairo_copy_clip_rectangle_list(), even if an
+//exception is thrown.
+class ClipRectangleList
+{
+public:
+  explicit ClipRectangleList(cairo_t* cr)
+  : m_list(cairo_copy_clip_rectangle_list(cr))
+  {}
+
+  ~ClipRectangleList() { cairo_rectangle_list_destroy(m_list); }
+
+  ClipRectangleList(const ClipRectangleList&) = delete;
+  ClipRectangleList& operator=(const ClipRectangleList&) = delete;
+
+  cairo_rectangle_list_t* operator->() const { return m_list; }
+
+private:
+  cairo_rectangle_list_t* m_list;
+};
+
+inline RectangleInt round_out(double x1, double y1, double x2, double y2)
+{
+  const auto left = std::floor(x1);
+  const auto top = std::floor(y1);
+  return RectangleInt{static_cast<int>(left), static_cast<int>(top),
+    static_cast<int>(std::ceil(x2) - left), static_cast<int>(std::ceil(y2) - top)};
+}
+
+} //anonymous namespace
+
 Context::Context(const RefPtr<Surface>& target)
 : m_cobject(nullptr)
 {
@@ -315,6 +348,46 @@ void Context::rectangle(double x, double y, double width, double height)
   check_object_status_and_throw_exception(*this);
 }
 
+void Context::move_to_lines(const double* xy, std::size_t n_points)
+{
+  if(n_points == 0)
+    return;
+
+  cairo_move_to(cobj(), xy[0], xy[1]);
+  polyline(xy + 2, n_points - 1);
+}
+
+void Context::polyline(const double* xy, std::size_t n_points)
+{
+  auto cr = cobj();
+  const auto end = xy + 2 * n_points;
+  for(; xy != end; xy += 2)
+    cairo_line_to(cr, xy[0], xy[1]);
+  check_object_status_and_throw_exception(*this);
+}
+
+void Context::polygon(const double* xy, std::size_t n_points)
+{
+  if(n_points == 0)
+    return;
+
+  auto cr = cobj();
+  cairo_move_to(cr, xy[0], xy[1]);
+  const auto end = xy + 2 * n_points;
+  for(xy += 2; xy != end; xy += 2)
+    cairo_line_to(cr, xy[0], xy[1]);
+  cairo_close_path(cr);
+  check_object_status_and_throw_exception(*this);
+}
+
+void Context::rectangles(const Rectangle* rects, std::size_t n_rects)
+{
+  auto cr = cobj();
+  for(const auto end = rects + n_rects; rects != end; ++rects)
+    cairo_rectangle(cr, rects->x, rects->y, rects->width, rects->height);
+  check_object_status_and_throw_exception(*this);
+}
+
 void Context::close_path()
 {
   cairo_close_path(cobj());
@@ -432,6 +505,30 @@ void Context::clip_preserve()
   check_object_status_and_throw_exception(*this);
 }
 
+void Context::clip(const RefPtr<const Region>& region)
+{
+  if(!region)
+    throw_exception(CAIRO_STATUS_NULL_POINTER);
+
+  auto cregion = region->cobj();
+  const auto n_rectangles = cairo_region_num_rectangles(cregion);
+  cairo_new_path(cobj());
+  for(int i = 0; i < n_rectangles; ++i)
+  {
+    RectangleInt rectangle;
+    cairo_region_get_rectangle(cregion, i, &rectangle);
+    cairo_rectangle(cobj(), rectangle.x, rectangle.y, rectangle.width, rectangle.height);
+  }
+  cairo_clip(cobj());
+  check_object_status_and_throw_exception(*this);
+}
+
+void Context::set_clip_region(const RefPtr<const Region>& region)
+{
+  cairo_reset_clip(cobj());
+  clip(region);
+}
+
 void Context::get_clip_extents(double& x1, double& y1, double& x2, double& y2) const
 {
   cairo_clip_extents(const_cast<cobject*>(const_cast<cobject*>(cobj())), &x1, &y1, &x2, &y2);
@@ -440,22 +537,80 @@ void Context::get_clip_extents(double& x1, double& y1, double& x2, double& y2) c
 
 void Context::copy_clip_rectangle_list(std::vector<Rectangle>& rectangles) const
 {
-  cairo_rectangle_list_t* c_list = nullptr;
   // It would be nice if the cairo interface didn't copy it into a C array first
   // and just let us do the copying...
-  c_list = cairo_copy_clip_rectangle_list(const_cast<cobject*>(const_cast<cobject*>(cobj())));
+  ClipRectangleList c_list(const_cast<cobject*>(cobj()));
   // the rectangle list contains a status field that we need to check and the
   // cairo context also has a status that we need to check
-  // FIXME: do we want to throw an exception if the clip can't be represented by
-  // rectangles?  or do we just want to return an empty list?
   check_status_and_throw_exception(c_list->status);
   check_object_status_and_throw_exception(*this);
   // copy the C array into the passed C++ list
   rectangles.assign(c_list->rectangles,
                     c_list->rectangles + c_list->num_rectangles);
-  // free the memory allocated to the C array since we've copied it into a
-  // standard C++ container
-  cairo_rectangle_list_destroy(c_list);
+}
+
+bool Context::clip_rectangles_into(std::vector<Rectangle>& rectangles) const
+{
+  ClipRectangleList c_list(const_cast<cobject*>(cobj()));
+  check_object_status_and_throw_exception(*this);
+  if(c_list->status == CAIRO_STATUS_CLIP_NOT_REPRESENTABLE)
+  {
+    rectangles.clear();
+    return false;
+  }
+
+  check_status_and_throw_exception(c_list->status);
+  rectangles.assign(c_list->rectangles,
+                    c_list->rectangles + c_list->num_rectangles);
+  return true;
+}
+
+Context::ClipInfo Context::get_clip_info() const
+{
+  auto cr = const_cast<cobject*>(cobj());
+  ClipInfo info;
+  cairo_clip_extents(cr, &info.x1, &info.y1, &info.x2, &info.y2);
+  info.rectangular = false;
+  info.n_rectangles = 0;
+
+  ClipRectangleList c_list(cr);
+  check_object_status_and_throw_exception(*this);
+  if(c_list->status == CAIRO_STATUS_CLIP_NOT_REPRESENTABLE)
+    return info;
+
+  check_status_and_throw_exception(c_list->status);
+  info.rectangular = true;
+  info.n_rectangles = c_list->num_rectangles;
+  return info;
+}
+
+RefPtr<Region> Context::copy_clip_region() const
+{
+  auto cr = const_cast<cobject*>(cobj());
+  ClipRectangleList c_list(cr);
+  check_object_status_and_throw_exception(*this);
+
+  std::vector<RectangleInt> rectangles;
+  if(c_list->status == CAIRO_STATUS_CLIP_NOT_REPRESENTABLE)
+  {
+    double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+    if(x2 > x1 && y2 > y1)
+      rectangles.push_back(round_out(x1, y1, x2, y2));
+  }
+  else
+  {
+    check_status_and_throw_exception(c_list->status);
+    rectangles.reserve(c_list->num_rectangles);
+    for(int i = 0; i < c_list->num_rectangles; ++i)
+    {
+      const auto& rectangle = c_list->rectangles[i];
+      rectangles.push_back(round_out(rectangle.x, rectangle.y,
+        rectangle.x + rectangle.width, rectangle.y + rectangle.height));
+    }
+  }
+
+  return Region::create(rectangles);
 }
 
 void Context::select_font_face(const std::string& family, FontSlant slant, FontWeight weight)
@@ -599,7 +754,7 @@ Operator Context::get_operator() const
   return result;
 }
 
-static RefPtr<Pattern> get_pattern_wrapper (cairo_pattern_t* pattern)
+static RefPtr<Pattern> create_pattern_wrapper (cairo_pattern_t* pattern)
 {
   auto pattern_type = cairo_pattern_get_type (pattern);
   switch (pattern_type)
@@ -621,6 +776,17 @@ static RefPtr<Pattern> get_pattern_wrapper (cairo_pattern_t* pattern)
   }
 }
 
+static RefPtr<Pattern> get_pattern_wrapper (cairo_pattern_t* pattern)
+{
+  auto wrapper = get_cached_wrapper(pattern);
+  if(wrapper)
+    return wrapper;
+
+  wrapper = create_pattern_wrapper(pattern);
+  cache_wrapper(wrapper);
+  return wrapper;
+}
+
 RefPtr<Pattern> Context::get_source()
 {
   auto pattern = cairo_get_source(cobj());
@@ -724,7 +890,7 @@ Matrix Context::get_matrix() const
 }
 
 static
-RefPtr<Surface> get_surface_wrapper (cairo_surface_t* surface)
+RefPtr<Surface> create_surface_wrapper (cairo_surface_t* surface)
 {
   auto surface_type = cairo_surface_get_type (surface);
   switch (surface_type)
@@ -782,6 +948,18 @@ RefPtr<Surface> get_surface_wrapper (cairo_surface_t* surface)
   }
 }
 
+static
+RefPtr<Surface> get_surface_wrapper (cairo_surface_t* surface)
+{
+  auto wrapper = get_cached_wrapper(surface);
+  if(wrapper)
+    return wrapper;
+
+  wrapper = create_surface_wrapper(surface);
+  cache_wrapper(wrapper);
+  return wrapper;
+}
+
 RefPtr<Surface> Context::get_target()
 {
   auto surface = cairo_get_target(const_cast<cobject*>(cobj()));
@@ -874,6 +1052,11 @@ RefPtr<const Surface> Context::get_group_target() const
   return get_surface_wrapper(surface);
 }
 
+void Context::check() const
+{
+  check_object_status_and_throw_exception(*this);
+}
+
 } //namespace Cairo
 
 // vim: ts=2 sw=2 et
@@ -26,6 +26,7 @@
 #include <cairomm/matrix.h>
 #include <cairomm/pattern.h>
 #include <cairomm/path.h>
+#include <cairomm/region.h>
 #include <cairomm/scaledfont.h>
 #include <cairomm/types.h>
 #include <valarray>
@@ -639,6 +640,75 @@ public:
    */
   void close_path();
 
+  /** Begins a new sub-path at the first of the given points and adds a line
+   * to each of the following points.
+   *
+   * This is equivalent to calling move_to() for the first point and
+   * line_to() for each remaining point, but the status of the Context is
+   * only checked once.
+   *
+   * @param xy	the coordinates of the points as x,y pairs: x0, y0, x1, y1, ...
+   * @param n_points	the number of points, which is half the number of
+   * doubles in @a xy.
+   */
+  void move_to_lines(const double* xy, std::size_t n_points);
+
+  /** Convenience overload for containers of x,y pairs, such as
+   * std::vector<double> or std::array<double, N>.
+   */
+  template <typename Container>
+  inline void move_to_lines(const Container& xy)
+  { move_to_lines(xy.data(), xy.size() / 2); }
+
+  /** Adds a line from the current point to each of the given points, in the
+   * same way as calling line_to() for each of them.
+   *
+   * If there is no current point the first point behaves as move_to().
+   *
+   * @param xy	the coordinates of the points as x,y pairs: x0, y0, x1, y1, ...
+   * @param n_points	the number of points, which is half the number of
+   * doubles in @a xy.
+   */
+  void polyline(const double* xy, std::size_t n_points);
+
+  /** Convenience overload for containers of x,y pairs, such as
+   * std::vector<double> or std::array<double, N>.
+   */
+  template <typename Container>
+  inline void polyline(const Container& xy)
+  { polyline(xy.data(), xy.size() / 2); }
+
+  /** Adds a closed sub-path through the given points. This is equivalent to
+   * move_to_lines() followed by close_path().
+   *
+   * @param xy	the coordinates of the points as x,y pairs: x0, y0, x1, y1, ...
+   * @param n_points	the number of points, which is half the number of
+   * doubles in @a xy.
+   */
+  void polygon(const double* xy, std::size_t n_points);
+
+  /** Convenience overload for containers of x,y pairs, such as
+   * std::vector<double> or std::array<double, N>.
+   */
+  template <typename Container>
+  inline void polygon(const Container& xy)
+  { polygon(xy.data(), xy.size() / 2); }
+
+  /** Adds a closed-subpath rectangle for each of the given rectangles, in
+   * the same way as calling rectangle() for each of them.
+   *
+   * @param rects	the rectangles, in user-space coordinates.
+   * @param n_rects	the number of rectangles.
+   */
+  void rectangles(const Rectangle* rects, std::size_t n_rects);
+
+  /** Convenience overload for containers of Rectangle, such as
+   * std::vector<Rectangle> or std::array<Rectangle, N>.
+   */
+  template <typename Container>
+  inline void rectangles(const Container& rects)
+  { rectangles(rects.data(), rects.size()); }
+
   /** A drawing operator that paints the current source everywhere within the
    * current clip region.
    */
@@ -908,6 +978,31 @@ public:
    */
   void clip_preserve();
 
+  /** Establishes a new clip region by intersecting the current clip region
+   * with @a region, whose rectangles are in user coordinates.
+   *
+   * This is equivalent to calling begin_new_path(), rectangle() for each
+   * rectangle of @a region and then clip(), but the status of the Context is
+   * only checked once. As with clip(), the current path is cleared.
+   *
+   * When the current transformation matrix is a translation by whole pixels,
+   * the rectangles are pixel-aligned in device space and cairo keeps the
+   * clip as a set of boxes, without rasterizing a path.
+   *
+   * @param region	the region to clip to.
+   *
+   * @sa set_clip_region()
+   */
+  void clip(const RefPtr<const Region>& region);
+
+  /** Replaces the current clip with @a region. This is equivalent to
+   * reset_clip() followed by clip(const RefPtr<const Region>&), so the same
+   * caveats as for reset_clip() apply.
+   *
+   * @param region	the new clip region, in user coordinates.
+   */
+  void set_clip_region(const RefPtr<const Region>& region);
+
   /**
    * Computes a bounding box in user coordinates covering the area inside the
    * current clip.
@@ -935,6 +1030,61 @@ public:
    */
   void copy_clip_rectangle_list(std::vector<Rectangle>& rectangles) const;
 
+  /** Gets the current clip region as a list of rectangles in user
+   * coordinates, like copy_clip_rectangle_list(), but returns false instead
+   * of throwing an exception if the clip cannot be represented as a list of
+   * user-space rectangles.
+   *
+   * The capacity of @a rectangles is reused, so passing the same vector
+   * again doesn't allocate once it is big enough. cairo itself still
+   * allocates and copies the list of rectangles on each call.
+   *
+   * @param rectangles a vector to store the rectangles into. It is cleared
+   * if the clip is not rectangular.
+   * @return whether the clip could be represented as rectangles.
+   */
+  bool clip_rectangles_into(std::vector<Rectangle>& rectangles) const;
+
+  /** A summary of the current clip, as returned by get_clip_info(). */
+  struct ClipInfo
+  {
+    /// The bounding box of the clip in user coordinates, as returned by
+    /// get_clip_extents().
+    double x1, y1, x2, y2;
+    /// Whether the clip can be represented as a list of user-space
+    /// rectangles, as returned by copy_clip_rectangle_list(). Since cairo
+    /// 1.12, this is only the case when the clip covers whole device pixels,
+    /// so a rectangle with fractional edges is not rectangular.
+    bool rectangular;
+    /// The number of rectangles of a rectangular clip, or 0.
+    int n_rectangles;
+  };
+
+  /** Gets the extents of the current clip and whether it is made of
+   * rectangles, without copying the rectangles into a vector. This is meant
+   * for code that checks the clip very often, for instance to skip drawing
+   * what lies outside of it.
+   *
+   * cairo has no way to tell whether the clip is made of rectangles without
+   * building the list of rectangles, so it still allocates and frees that
+   * list on each call.
+   */
+  ClipInfo get_clip_info() const;
+
+  /** Gets a region that covers the current clip, in user coordinates.
+   *
+   * The rectangles of the clip are rounded outwards to whole units, so the
+   * region is exact when the clip is pixel-aligned and the current
+   * transformation matrix is a translation by whole pixels. If the clip
+   * cannot be represented as rectangles, the region covers its extents.
+   * Like get_clip_info(), this makes cairo allocate the list of rectangles.
+   *
+   * @return a new region.
+   *
+   * @sa clip(const RefPtr<const Region>&)
+   */
+  RefPtr<Region> copy_clip_region() const;
+
   /**
    * Selects a family and style of font from a simplified description as a
    * family name, slant and weight. Cairo provides no operation to list
@@ -1321,8 +1471,8 @@ public:
   //TODO: Copy or reference-count a Path somethow instead of asking the caller to delete it?
   /** Creates a copy of the current path and returns it to the user.
    *
-   * @todo See cairo_path_data_t for hints on how to iterate over the returned
-   * data structure.
+   * The segments of the returned Path can be walked with Path::begin() and
+   * Path::end().
    *
    * @note The caller owns the Path object returned from this function.  The
    * Path object must be freed when you are finished with it.
@@ -1360,9 +1510,6 @@ public:
   void get_path_extents(double& x1, double& y1, double& x2, double& y2) const;
 
   /** Gets a flattened copy of the current path and returns it to the user
-   *
-   * @todo See cairo_path_data_t for hints on how to iterate over the returned
-   * data structure.
    *
    * This function is like copy_path() except that any curves in the path will
    * be approximated with piecewise-linear approximations, (accurate to within
@@ -1500,6 +1647,96 @@ public:
    */
   RefPtr<const Surface> get_group_target() const;
 
+  /** Throws an exception if an error occurred in any earlier call on this
+   * Context.
+   *
+   * A cairo context keeps the first error that occurs and ignores all later
+   * drawing calls, so checking once after a batch of unchecked() calls is
+   * enough to notice the error.
+   *
+   * @exception
+   */
+  void check() const;
+
+  /** A view of a Context whose drawing methods don't check the status of the
+   * Context after every call. They are inline and cost just the underlying
+   * cairo call, which makes them suitable for building long paths.
+   *
+   * Errors are not lost: call Context::check() when the batch is complete.
+   *
+   * An Unchecked view does not hold a reference to the Context, so it must
+   * not outlive it.
+   *
+   * @code
+   * auto u = cr->unchecked();
+   * u.move_to(points[0].x, points[0].y);
+   * for(const auto& point : points)
+   *   u.line_to(point.x, point.y);
+   * cr->check();
+   * @endcode
+   *
+   * The methods behave like the Context methods with the same names.
+   */
+  class Unchecked
+  {
+  public:
+    explicit Unchecked(cairo_t* cobject)
+    : m_cobject(cobject)
+    {}
+
+    void save() { cairo_save(m_cobject); }
+    void restore() { cairo_restore(m_cobject); }
+
+    void set_operator(Operator op)
+    { cairo_set_operator(m_cobject, static_cast<cairo_operator_t>(op)); }
+    void set_source_rgb(double red, double green, double blue)
+    { cairo_set_source_rgb(m_cobject, red, green, blue); }
+    void set_source_rgba(double red, double green, double blue, double alpha)
+    { cairo_set_source_rgba(m_cobject, red, green, blue, alpha); }
+    void set_line_width(double width) { cairo_set_line_width(m_cobject, width); }
+
+    void translate(double tx, double ty) { cairo_translate(m_cobject, tx, ty); }
+    void scale(double sx, double sy) { cairo_scale(m_cobject, sx, sy); }
+    void rotate(double angle_radians) { cairo_rotate(m_cobject, angle_radians); }
+    void transform(const Matrix& matrix) { cairo_transform(m_cobject, &matrix); }
+    void set_matrix(const Matrix& matrix) { cairo_set_matrix(m_cobject, &matrix); }
+    void set_identity_matrix() { cairo_identity_matrix(m_cobject); }
+
+    void begin_new_path() { cairo_new_path(m_cobject); }
+    void begin_new_sub_path() { cairo_new_sub_path(m_cobject); }
+    void move_to(double x, double y) { cairo_move_to(m_cobject, x, y); }
+    void line_to(double x, double y) { cairo_line_to(m_cobject, x, y); }
+    void curve_to(double x1, double y1, double x2, double y2, double x3, double y3)
+    { cairo_curve_to(m_cobject, x1, y1, x2, y2, x3, y3); }
+    void arc(double xc, double yc, double radius, double angle1, double angle2)
+    { cairo_arc(m_cobject, xc, yc, radius, angle1, angle2); }
+    void arc_negative(double xc, double yc, double radius, double angle1, double angle2)
+    { cairo_arc_negative(m_cobject, xc, yc, radius, angle1, angle2); }
+    void rel_move_to(double dx, double dy) { cairo_rel_move_to(m_cobject, dx, dy); }
+    void rel_line_to(double dx, double dy) { cairo_rel_line_to(m_cobject, dx, dy); }
+    void rel_curve_to(double dx1, double dy1, double dx2, double dy2, double dx3, double dy3)
+    { cairo_rel_curve_to(m_cobject, dx1, dy1, dx2, dy2, dx3, dy3); }
+    void rectangle(double x, double y, double width, double height)
+    { cairo_rectangle(m_cobject, x, y, width, height); }
+    void close_path() { cairo_close_path(m_cobject); }
+
+    void paint() { cairo_paint(m_cobject); }
+    void stroke() { cairo_stroke(m_cobject); }
+    void stroke_preserve() { cairo_stroke_preserve(m_cobject); }
+    void fill() { cairo_fill(m_cobject); }
+    void fill_preserve() { cairo_fill_preserve(m_cobject); }
+    void clip() { cairo_clip(m_cobject); }
+    void clip_preserve() { cairo_clip_preserve(m_cobject); }
+
+  private:
+    cairo_t* m_cobject;
+  };
+
+  /** Gets a view of this Context whose drawing methods don't check for errors.
+   * Call check() afterwards.
+   */
+  inline Unchecked unchecked() { return Unchecked(m_cobject); }
+
   /** The base cairo C type that is wrapped by Cairo::Context
    */
   typedef cairo_t cobject;
@@ -0,0 +1,261 @@
+/* Copyright (C) 2026 The cairomm Development Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <cairomm/context_pool.h>
+#include <cairomm/private.h>
+#include <algorithm>
+#include <mutex>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Cairo
+{
+
+namespace
+{
+
+//cairo can't change the target of a cairo_t, so a context is rebound by
+//giving its wrapper a new cairo_t.
+class PooledContext : public Context
+{
+public:
+  explicit PooledContext(cairo_t* cobject)
+  : Context(cobject, true)
+  {}
+
+  void rebind(cairo_t* cobject)
+  {
+    cairo_destroy(m_cobject);
+    m_cobject = cobject;
+  }
+};
+
+//Marks the cairo_t of a PooledContext, so that release() can recognize it.
+const cairo_user_data_key_t USER_DATA_KEY_POOLED_CONTEXT = {0};
+
+//Creates a cairo_t for target. The default state is saved at the bottom of
+//its stack, so that it can be restored when the context is released.
+cairo_t* create_pooled_cobject(const RefPtr<Surface>& target)
+{
+  auto cobject = cairo_create(target->cobj());
+  auto status = cairo_status(cobject);
+  if(status == CAIRO_STATUS_SUCCESS)
+    status = cairo_set_user_data(cobject, &USER_DATA_KEY_POOLED_CONTEXT, cobject, nullptr);
+
+  if(status != CAIRO_STATUS_SUCCESS)
+  {
+    cairo_destroy(cobject);
+    throw_exception(status);
+  }
+
+  cairo_save(cobject);
+  return cobject;
+}
+
+bool is_last_reference(const RefPtr<Context>& context)
+{
+#ifndef CAIROMM_INTRUSIVE_REFPTR
+  return context.use_count() == 1;
+#else
+  return cairo_get_reference_count(context->cobj()) == 1;
+#endif
+}
+
+//A part of the pool with its own lock. The threads are spread over the
+//shards by their id, and each shard keeps at most capacity contexts, so that
+//the contexts released by threads that have exited are reused by other
+//threads or destroyed, instead of being kept forever.
+struct ContextPoolShard
+{
+  struct Entry
+  {
+    std::thread::id thread;
+    RefPtr<Context> context;
+  };
+
+  std::mutex mutex;
+
+  //The released contexts, the most recently released last.
+  std::vector<Entry> entries;
+
+  std::size_t capacity = 0;
+  unsigned long long hits = 0;
+  unsigned long long rebinds = 0;
+  unsigned long long misses = 0;
+  unsigned long long evictions = 0;
+};
+
+} //anonymous namespace
+
+struct ContextPool::Impl
+{
+  Impl(std::size_t max_contexts, unsigned int n_shards)
+  : n_shards(std::max<std::size_t>(1, std::min<std::size_t>(n_shards, max_contexts))),
+    shards(new ContextPoolShard[this->n_shards])
+  {
+    //The maximum is for the whole pool, so it is divided, not rounded up.
+    for(std::size_t i = 0; i < this->n_shards; ++i)
+      shards[i].capacity = max_contexts / this->n_shards + (i < max_contexts % this->n_shards ? 1 : 0);
+  }
+
+  ContextPoolShard& get_shard(std::thread::id thread)
+  {
+    return shards[std::hash<std::thread::id>()(thread) % n_shards];
+  }
+
+  const std::size_t n_shards;
+  std::unique_ptr<ContextPoolShard[]> shards;
+};
+
+ContextPool::ContextPool(std::size_t max_contexts, unsigned int n_shards)
+: m_impl(new Impl(max_contexts, n_shards))
+{
+}
+
+ContextPool::~ContextPool()
+{
+}
+
+RefPtr<Context> ContextPool::acquire(const RefPtr<Surface>& target)
+{
+  const auto thread = std::this_thread::get_id();
+  auto& shard = m_impl->get_shard(thread);
+
+  RefPtr<Context> context;
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    //Prefers a context that drew to the same target, the most recently
+    //released one, and then a context of the calling thread. If none drew to
+    //the same target, the least recently released one is rebound.
+    auto best = shard.entries.end();
+    int best_score = -1;
+    for(auto entry = shard.entries.begin(); entry != shard.entries.end(); ++entry)
+    {
+      const int score = (cairo_get_target(entry->context->cobj()) == target->cobj() ? 2 : 0) +
+        (entry->thread == thread ? 1 : 0);
+      if(score > best_score || (score == best_score && score >= 2))
+      {
+        best = entry;
+        best_score = score;
+      }
+    }
+
+    if(best == shard.entries.end())
+      ++shard.misses;
+    else
+    {
+      context = std::move(best->context);
+      shard.entries.erase(best);
+      if(best_score >= 2)
+      {
+        ++shard.hits;
+        return context;
+      }
+
+      ++shard.rebinds;
+    }
+  }
+
+  auto cobject = create_pooled_cobject(target);
+  if(context)
+    static_cast<PooledContext*>(context.get())->rebind(cobject);
+  else
+    context = make_refptr_for_instance<Context>(new PooledContext(cobject));
+
+  return context;
+}
+
+void ContextPool::release(RefPtr<Context>& context)
+{
+  //Destroyed after the lock, if it is not kept.
+  auto released = std::move(context);
+  context.reset();
+  if(!released)
+    return;
+
+  auto cobject = released->cobj();
+  if(!cairo_get_user_data(cobject, &USER_DATA_KEY_POOLED_CONTEXT) ||
+     !is_last_reference(released) ||
+     cairo_status(cobject) != CAIRO_STATUS_SUCCESS ||
+     cairo_get_group_target(cobject) != cairo_get_target(cobject))
+    return;
+
+  //The path is not part of the saved state.
+  cairo_new_path(cobject);
+  cairo_restore(cobject);
+  cairo_save(cobject);
+
+  //An unbalanced restore() has popped the default state.
+  if(cairo_status(cobject) != CAIRO_STATUS_SUCCESS)
+    return;
+
+  //Destroyed after the lock, if the shard is full.
+  RefPtr<Context> evicted;
+
+  const auto thread = std::this_thread::get_id();
+  auto& shard = m_impl->get_shard(thread);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if(shard.capacity == 0)
+    return;
+
+  if(shard.entries.size() == shard.capacity)
+  {
+    evicted = std::move(shard.entries.front().context);
+    shard.entries.erase(shard.entries.begin());
+    ++shard.evictions;
+  }
+
+  shard.entries.push_back(ContextPoolShard::Entry{thread, std::move(released)});
+}
+
+void ContextPool::clear()
+{
+  for(std::size_t i = 0; i < m_impl->n_shards; ++i)
+  {
+    auto& shard = m_impl->shards[i];
+    std::vector<ContextPoolShard::Entry> entries;
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      entries.swap(shard.entries);
+    }
+  }
+}
+
+ContextPool::Statistics ContextPool::get_statistics() const
+{
+  Statistics statistics = {0, 0, 0, 0, 0};
+  for(std::size_t i = 0; i < m_impl->n_shards; ++i)
+  {
+    auto& shard = m_impl->shards[i];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    statistics.hits += shard.hits;
+    statistics.rebinds += shard.rebinds;
+    statistics.misses += shard.misses;
+    statistics.evictions += shard.evictions;
+    statistics.size += shard.entries.size();
+  }
+
+  return statistics;
+}
+
+} //namespace Cairo
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,144 @@
+/* Copyright (C) 2026 The cairomm Development Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __CAIROMM_CONTEXT_POOL_H
+#define __CAIROMM_CONTEXT_POOL_H
+
+#include <cairomm/context.h>
+#include <cairomm/refptr.h>
+#include <cairomm/surface.h>
+#include <cstddef>
+#include <memory>
+
+namespace Cairo
+{
+
+/**
+ * Hands out Context objects that are reused instead of being created for
+ * every drawing operation.
+ *
+ * Context::create() calls cairo_create() and allocates a new wrapper each
+ * time. A ContextPool keeps the contexts that are given back with release(),
+ * and returns them again from acquire(). A thread gets back the contexts
+ * that it released itself first, and the contexts that drew to the same
+ * surface before others.
+ *
+ * @code
+ * static Cairo::ContextPool pool;
+ * auto cr = pool.acquire(tile_surface);
+ * draw_tile(cr);
+ * pool.release(cr);
+ * @endcode
+ *
+ * A context returned by acquire() is always in the same state as one created
+ * by Context::create(): it has an identity matrix, a black source, no path,
+ * no clip, and the default values for all the other drawing options. A
+ * context that drew to another surface is rebound to the new target, which
+ * keeps its wrapper but needs a new cairo context.
+ *
+ * A context should be released with balanced calls to Context::save() and
+ * Context::restore(), and to Context::push_group() and Context::pop_group().
+ * Contexts that are still in a group, that are in an error state, or that
+ * are still referenced elsewhere are not reused. Contexts that are not
+ * released simply go away with their last RefPtr.
+ *
+ * The number of contexts kept for reuse is limited for the whole pool, and the
+ * least recently released ones are destroyed first. A pooled context keeps a
+ * reference to the surface it last drew to, until it is reused for another
+ * surface, evicted, or the pool is cleared, so the contexts of threads that
+ * have exited don't pile up.
+ *
+ * A ContextPool may be used from several threads at once. The threads are
+ * spread over independently locked shards, so they rarely wait for each
+ * other.
+ */
+class ContextPool
+{
+public:
+  /** Counters describing the use of a ContextPool. */
+  struct Statistics
+  {
+    /// The number of contexts reused for the same target surface.
+    unsigned long long hits;
+    /// The number of contexts reused for a different target surface.
+    unsigned long long rebinds;
+    /// The number of contexts that had to be created.
+    unsigned long long misses;
+    /// The number of contexts destroyed to respect the maximum size.
+    unsigned long long evictions;
+    /// The number of contexts kept for reuse, for all threads.
+    std::size_t size;
+  };
+
+  /** Creates an empty pool.
+   *
+   * @param max_contexts the maximum number of contexts kept for reuse, for
+   * all threads. It is divided between the shards.
+   * @param n_shards the number of independently locked parts of the pool.
+   */
+  explicit ContextPool(std::size_t max_contexts = 64, unsigned int n_shards = 16);
+
+  ContextPool(const ContextPool&) = delete;
+  ContextPool& operator=(const ContextPool&) = delete;
+
+  /** Destroys the contexts kept for reuse. Contexts that have been acquired
+   * and not released stay valid.
+   */
+  virtual ~ContextPool();
+
+  /** Gets a context that draws to @a target, reusing one released earlier if
+   * possible.
+   *
+   * @param target the surface to draw to
+   * @return a context in its default state.
+   *
+   * @exception Cairo::logic_error if a new cairo context could not be
+   * created for @a target.
+   */
+  RefPtr<Context> acquire(const RefPtr<Surface>& target);
+
+  /** Gives a context back to the pool and resets @a context. The context is
+   * kept for reuse only if it was created by a ContextPool and @a context is
+   * its last RefPtr. Otherwise the RefPtr is just reset.
+   *
+   * The path of a kept context is cleared, and its drawing state is reset to
+   * the default.
+   */
+  void release(RefPtr<Context>& context);
+
+  /** Destroys the contexts kept for reuse, for all threads. The statistics
+   * are kept.
+   */
+  void clear();
+
+  /** Gets the current statistics of the pool. */
+  Statistics get_statistics() const;
+
+#ifndef DOXYGEN_IGNORE_THIS
+  struct Impl;
+#endif //DOXYGEN_IGNORE_THIS
+
+protected:
+  std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace Cairo
+
+#endif //__CAIROMM_CONTEXT_POOL_H
+
+// vim: ts=2 sw=2 et
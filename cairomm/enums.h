@@ -805,6 +805,35 @@ typedef enum
     REGION_OVERLAP_PART = CAIRO_REGION_OVERLAP_PART
 } RegionOverlap;
 
+/**
+ * Cairo::PathDataType is used to describe the type of one portion of a path
+ * when represented as a Path.
+ *
+ * See Path::Segment.
+ **/
+typedef enum
+{
+    /**
+     * A move-to operation
+     */
+    PATH_MOVE_TO = CAIRO_PATH_MOVE_TO,
+
+    /**
+     * A line-to operation
+     */
+    PATH_LINE_TO = CAIRO_PATH_LINE_TO,
+
+    /**
+     * A curve-to operation
+     */
+    PATH_CURVE_TO = CAIRO_PATH_CURVE_TO,
+
+    /**
+     * A close-path operation
+     */
+    PATH_CLOSE_PATH = CAIRO_PATH_CLOSE_PATH
+} PathDataType;
+
 /**
  * A set of synthesis options to control how FreeType renders the glyphs for a
  * particular font face.
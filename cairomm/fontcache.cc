@@ -0,0 +1,310 @@
+/* Copyright (C) 2026 The cairomm Development Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <cairomm/fontcache.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Cairo
+{
+
+namespace
+{
+
+inline void hash_combine(std::size_t& seed, std::size_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+void hash_matrix(std::size_t& seed, const Matrix& matrix)
+{
+  std::hash<double> hash_double;
+  hash_combine(seed, hash_double(matrix.xx));
+  hash_combine(seed, hash_double(matrix.yx));
+  hash_combine(seed, hash_double(matrix.xy));
+  hash_combine(seed, hash_double(matrix.yy));
+  hash_combine(seed, hash_double(matrix.x0));
+  hash_combine(seed, hash_double(matrix.y0));
+}
+
+bool matrices_equal(const Matrix& a, const Matrix& b)
+{
+  return a.xx == b.xx && a.yx == b.yx && a.xy == b.xy && a.yy == b.yy &&
+    a.x0 == b.x0 && a.y0 == b.y0;
+}
+
+struct FaceKey
+{
+  std::string family;
+  FontSlant slant;
+  FontWeight weight;
+
+  std::size_t hash() const
+  {
+    auto seed = std::hash<std::string>()(family);
+    hash_combine(seed, static_cast<std::size_t>(slant));
+    hash_combine(seed, static_cast<std::size_t>(weight));
+    return seed;
+  }
+
+  bool operator==(const FaceKey& other) const
+  {
+    return slant == other.slant && weight == other.weight && family == other.family;
+  }
+};
+
+struct ScaledFontKey
+{
+  FaceKey face;
+  Matrix font_matrix;
+  Matrix ctm;
+  FontOptions options;
+  //The hash of the options is kept because computing it calls into cairo.
+  unsigned long options_hash;
+
+  std::size_t hash() const
+  {
+    auto seed = face.hash();
+    hash_matrix(seed, font_matrix);
+    hash_matrix(seed, ctm);
+    hash_combine(seed, static_cast<std::size_t>(options_hash));
+    return seed;
+  }
+
+  bool operator==(const ScaledFontKey& other) const
+  {
+    return options_hash == other.options_hash && face == other.face &&
+      matrices_equal(font_matrix, other.font_matrix) &&
+      matrices_equal(ctm, other.ctm) && options == other.options;
+  }
+};
+
+//The hash is computed once by the caller, to pick the shard, and stored next
+//to the key.
+template <typename T_Key>
+struct HashedKey
+{
+  T_Key key;
+  std::size_t hash;
+
+  bool operator==(const HashedKey& other) const
+  { return hash == other.hash && key == other.key; }
+};
+
+template <typename T_Key>
+struct HashedKeyHash
+{
+  std::size_t operator()(const HashedKey<T_Key>& key) const { return key.hash; }
+};
+
+//One independently locked part of a least-recently-used cache.
+template <typename T_Key, typename T_Value>
+class LruShard
+{
+public:
+  typedef HashedKey<T_Key> Key;
+
+  bool find(const Key& key, T_Value& value)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_index.find(key);
+    if(found == m_index.end())
+      return false;
+
+    //Move the entry to the front of the list.
+    m_entries.splice(m_entries.begin(), m_entries, found->second);
+    value = found->second->second;
+    return true;
+  }
+
+  //Returns the value that ends up in the cache, which is not value if
+  //another thread inserted the same key first. Returns the number of
+  //entries that were evicted in n_evicted.
+  T_Value insert(const Key& key, const T_Value& value, std::size_t capacity,
+    std::size_t& n_evicted)
+  {
+    //Evicted values are released after the lock, because releasing a font
+    //can call back into user code.
+    std::vector<T_Value> evicted;
+    T_Value result;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto found = m_index.find(key);
+      if(found != m_index.end())
+      {
+        m_entries.splice(m_entries.begin(), m_entries, found->second);
+        return found->second->second;
+      }
+
+      m_entries.emplace_front(key, value);
+      m_index.emplace(key, m_entries.begin());
+      while(m_entries.size() > capacity)
+      {
+        evicted.push_back(m_entries.back().second);
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+      }
+      result = value;
+    }
+
+    n_evicted = evicted.size();
+    return result;
+  }
+
+  void clear()
+  {
+    std::list<std::pair<Key, T_Value>> entries;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_index.clear();
+      entries.swap(m_entries);
+    }
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+  }
+
+private:
+  typedef std::list<std::pair<Key, T_Value>> List;
+
+  mutable std::mutex m_mutex;
+  List m_entries; //Most recently used first.
+  std::unordered_map<Key, typename List::iterator, HashedKeyHash<T_Key>> m_index;
+};
+
+} //anonymous namespace
+
+struct FontCache::Impl
+{
+  Impl(std::size_t capacity, unsigned int n_shards)
+  : face_shards(n_shards),
+    font_shards(n_shards),
+    shard_capacity((capacity + n_shards - 1) / n_shards),
+    hits(0), misses(0), evictions(0)
+  {}
+
+  std::vector<LruShard<FaceKey, RefPtr<ToyFontFace>>> face_shards;
+  std::vector<LruShard<ScaledFontKey, RefPtr<ScaledFont>>> font_shards;
+  std::size_t shard_capacity;
+
+  std::atomic<unsigned long long> hits, misses, evictions;
+
+  //Doesn't count hits and misses, so that get_scaled_font() only counts the
+  //scaled font.
+  RefPtr<ToyFontFace> get_font_face(const std::string& family, FontSlant slant,
+    FontWeight weight, bool& hit)
+  {
+    HashedKey<FaceKey> key = {FaceKey{family, slant, weight}, 0};
+    key.hash = key.key.hash();
+    auto& shard = face_shards[key.hash % face_shards.size()];
+
+    RefPtr<ToyFontFace> face;
+    hit = shard.find(key, face);
+    if(hit)
+      return face;
+
+    //Created without the lock, so other threads are not blocked meanwhile.
+    face = ToyFontFace::create(family, slant, weight);
+    std::size_t n_evicted = 0;
+    face = shard.insert(key, face, shard_capacity, n_evicted);
+    evictions += n_evicted;
+    return face;
+  }
+};
+
+FontCache::FontCache(std::size_t capacity, unsigned int n_shards)
+: m_impl(new Impl(std::max<std::size_t>(capacity, 1), std::max(n_shards, 1u)))
+{
+}
+
+FontCache::~FontCache()
+{
+}
+
+RefPtr<ToyFontFace> FontCache::get_font_face(const std::string& family, FontSlant slant, FontWeight weight)
+{
+  bool hit = false;
+  auto face = m_impl->get_font_face(family, slant, weight, hit);
+  ++(hit ? m_impl->hits : m_impl->misses);
+  return face;
+}
+
+RefPtr<ScaledFont> FontCache::get_scaled_font(const std::string& family, FontSlant slant,
+  FontWeight weight, const Matrix& font_matrix, const Matrix& ctm, const FontOptions& options)
+{
+  //cairo ignores the translation of the ctm, so fonts drawn at different
+  //offsets share an entry.
+  auto key_ctm = ctm;
+  key_ctm.x0 = 0.0;
+  key_ctm.y0 = 0.0;
+  HashedKey<ScaledFontKey> key = {
+    ScaledFontKey{FaceKey{family, slant, weight}, font_matrix, key_ctm, options, options.hash()}, 0};
+  key.hash = key.key.hash();
+  auto& shard = m_impl->font_shards[key.hash % m_impl->font_shards.size()];
+
+  RefPtr<ScaledFont> font;
+  if(shard.find(key, font))
+  {
+    ++m_impl->hits;
+    return font;
+  }
+
+  ++m_impl->misses;
+  bool face_hit = false;
+  auto face = m_impl->get_font_face(family, slant, weight, face_hit);
+  font = ScaledFont::create(face, font_matrix, ctm, options);
+  std::size_t n_evicted = 0;
+  font = shard.insert(key, font, m_impl->shard_capacity, n_evicted);
+  m_impl->evictions += n_evicted;
+  return font;
+}
+
+void FontCache::clear()
+{
+  for(auto& shard : m_impl->font_shards)
+    shard.clear();
+  for(auto& shard : m_impl->face_shards)
+    shard.clear();
+}
+
+FontCache::Statistics FontCache::get_statistics() const
+{
+  Statistics statistics;
+  statistics.hits = m_impl->hits;
+  statistics.misses = m_impl->misses;
+  statistics.evictions = m_impl->evictions;
+  statistics.size = 0;
+  for(const auto& shard : m_impl->font_shards)
+    statistics.size += shard.size();
+  for(const auto& shard : m_impl->face_shards)
+    statistics.size += shard.size();
+  return statistics;
+}
+
+} //namespace Cairo
+
+// vim: ts=2 sw=2 et
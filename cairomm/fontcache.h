@@ -0,0 +1,129 @@
+/* Copyright (C) 2026 The cairomm Development Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __CAIROMM_FONTCACHE_H
+#define __CAIROMM_FONTCACHE_H
+
+#include <cairomm/enums.h>
+#include <cairomm/fontface.h>
+#include <cairomm/fontoptions.h>
+#include <cairomm/matrix.h>
+#include <cairomm/refptr.h>
+#include <cairomm/scaledfont.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace Cairo
+{
+
+/**
+ * A cache of toy font faces and scaled fonts that can be shared between
+ * threads.
+ *
+ * ToyFontFace::create() and ScaledFont::create() resolve the font again and
+ * create a new wrapper on every call. A FontCache returns the same
+ * RefPtr<ScaledFont> for the same family, slant, weight, font matrix, CTM and
+ * font options, so that the font is only resolved once.
+ *
+ * @code
+ * static Cairo::FontCache cache;
+ * auto font = cache.get_scaled_font("Sans", Cairo::FONT_SLANT_NORMAL,
+ *   Cairo::FONT_WEIGHT_BOLD, Cairo::scaling_matrix(12, 12), cr->get_matrix());
+ * cr->set_scaled_font(font);
+ * @endcode
+ *
+ * The least recently used fonts are evicted when the cache is full. The cache
+ * is divided into shards with their own locks, so threads looking up
+ * different fonts rarely wait for each other.
+ */
+class FontCache
+{
+public:
+  /** Counters describing the use of a FontCache. */
+  struct Statistics
+  {
+    /// The number of lookups that found a cached font or font face.
+    unsigned long long hits;
+    /// The number of lookups that had to create a font or font face.
+    unsigned long long misses;
+    /// The number of fonts and font faces removed to make room.
+    unsigned long long evictions;
+    /// The number of fonts and font faces in the cache.
+    std::size_t size;
+  };
+
+  /** Creates an empty cache.
+   *
+   * @param capacity the maximum number of scaled fonts to keep. The same
+   * number of font faces is kept.
+   * @param n_shards the number of independently locked parts of the cache.
+   */
+  explicit FontCache(std::size_t capacity = 256, unsigned int n_shards = 16);
+
+  FontCache(const FontCache&) = delete;
+  FontCache& operator=(const FontCache&) = delete;
+
+  virtual ~FontCache();
+
+  /** Gets a toy font face, creating it with ToyFontFace::create() if it is
+   * not in the cache.
+   *
+   * @param family a font family name, encoded in UTF-8.
+   * @param slant the slant for the font.
+   * @param weight the weight for the font.
+   */
+  RefPtr<ToyFontFace> get_font_face(const std::string& family, FontSlant slant, FontWeight weight);
+
+  /** Gets a scaled font for a toy font face, creating it with
+   * ScaledFont::create() if it is not in the cache.
+   *
+   * @param family a font family name, encoded in UTF-8.
+   * @param slant the slant for the font.
+   * @param weight the weight for the font.
+   * @param font_matrix font space to user space transformation matrix for the
+   * font. See ScaledFont::create().
+   * @param ctm user to device transformation matrix with which the font will
+   * be used. Its translation is ignored, like cairo does.
+   * @param options options to use when getting metrics for the font and
+   * rendering with it.
+   */
+  RefPtr<ScaledFont> get_scaled_font(const std::string& family, FontSlant slant, FontWeight weight,
+    const Matrix& font_matrix, const Matrix& ctm, const FontOptions& options = FontOptions());
+
+  /** Removes all fonts and font faces from the cache. The statistics are
+   * kept.
+   */
+  void clear();
+
+  /** Gets the current statistics of the cache. */
+  Statistics get_statistics() const;
+
+#ifndef DOXYGEN_IGNORE_THIS
+  struct Impl;
+#endif //DOXYGEN_IGNORE_THIS
+
+protected:
+  std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace Cairo
+
+#endif //__CAIROMM_FONTCACHE_H
+
+// vim: ts=2 sw=2 et
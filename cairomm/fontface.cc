@@ -16,19 +16,16 @@
  * 02110-1301, USA.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <cairomm/context.h>
 #include <cairomm/fontface.h>
+#include <cairomm/glyphatlas_private.h>
 #include <cairomm/scaledfont.h>
 #include <cairomm/private.h>
 
-namespace
-{
-
-static const cairo_user_data_key_t USER_DATA_KEY_DEFAULT_TEXT_TO_GLYPHS =  {0};
-
-} // anonymous namespace
-
 namespace Cairo
 {
 
@@ -117,6 +114,258 @@ FontWeight ToyFontFace::get_weight() const
 
 static const cairo_user_data_key_t user_font_key = {0};
 
+namespace
+{
+
+// A wrapper that doesn't hold a reference to its C instance, so that it can
+// be kept in the user data of the scaled font and pointed at the Context of
+// each callback.
+template <class T>
+class Borrowed : public T
+{
+public:
+  explicit Borrowed(typename T::cobject* cobject)
+  : T(cobject, true /* doesn't take a reference */)
+  {}
+
+  ~Borrowed() override
+  {
+    this->m_cobject = nullptr;
+  }
+
+  void rebind(typename T::cobject* cobject)
+  {
+    this->m_cobject = cobject;
+  }
+};
+
+inline unsigned int get_reference_count(cairo_t* cobject)
+{ return cairo_get_reference_count(cobject); }
+
+inline unsigned int get_reference_count(cairo_scaled_font_t* cobject)
+{ return cairo_scaled_font_get_reference_count(cobject); }
+
+#ifndef CAIROMM_INTRUSIVE_REFPTR
+// Does nothing while the wrapper belongs to a WrapperSlot. If a callback keeps
+// a RefPtr, the wrapper is detached from the slot and then owned by the RefPtr.
+template <class T>
+struct DetachableDeleter
+{
+  bool detached = false;
+
+  void operator()(T* object) const
+  {
+    if(detached)
+    {
+      object->unreference();
+      delete object;
+    }
+  }
+};
+#else
+// Owns a detached Context wrapper, until its cairo_t is destroyed.
+struct DetachedContext
+{
+  cairo_user_data_key_t key;
+  std::unique_ptr<Borrowed<Context>> wrapper;
+
+  static void destroy(void* data)
+  {
+    delete static_cast<DetachedContext*>(data);
+  }
+};
+
+inline void detach(std::unique_ptr<Borrowed<Context>>& wrapper)
+{
+  // the address of the key is unique, so no other user data is replaced
+  auto detached = new DetachedContext;
+  auto cobject = wrapper->cobj();
+  detached->wrapper = std::move(wrapper);
+  if(cairo_set_user_data(cobject, &detached->key, detached, &DetachedContext::destroy) != CAIRO_STATUS_SUCCESS)
+    detached->wrapper.release(); // leaked, so that the RefPtrs stay valid
+}
+
+inline void detach(std::unique_ptr<Borrowed<ScaledFont>>& /* wrapper */)
+{
+  // the wrapper is never rebound, and the WrapperSlot lives as long as the
+  // scaled font, which the RefPtrs keep alive
+}
+#endif //CAIROMM_INTRUSIVE_REFPTR
+
+// One reusable wrapper, handed to one callback at a time.
+template <class T>
+class WrapperSlot
+{
+public:
+  /// Returns the wrapper pointed at @a cobject, or an empty RefPtr if it is
+  /// already in use by another callback.
+  RefPtr<T> acquire(typename T::cobject* cobject)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_in_use)
+      return RefPtr<T>();
+
+    if(!m_wrapper)
+    {
+      m_wrapper.reset(new Borrowed<T>(cobject));
+#ifndef CAIROMM_INTRUSIVE_REFPTR
+      m_refptr = RefPtr<T>(m_wrapper.get(), DetachableDeleter<T>());
+#endif
+    }
+    else
+      m_wrapper->rebind(cobject);
+
+    m_in_use = true;
+#ifndef CAIROMM_INTRUSIVE_REFPTR
+    return m_refptr;
+#else
+    m_reference_count = get_reference_count(cobject);
+    m_wrapper->reference();
+    return RefPtr<T>(m_wrapper.get());
+#endif
+  }
+
+  /// Releases @a wrapper. If the callback kept a copy of it, the wrapper is
+  /// detached so that it is not rebound.
+  void release(RefPtr<T>& wrapper)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool ours = m_in_use && wrapper.get() == m_wrapper.get();
+    wrapper.reset();
+    if(!ours)
+      return;
+
+    m_in_use = false;
+#ifndef CAIROMM_INTRUSIVE_REFPTR
+    if(m_refptr.use_count() > 1)
+    {
+      std::get_deleter<DetachableDeleter<T>>(m_refptr)->detached = true;
+      m_wrapper.release()->reference();
+      m_refptr.reset();
+    }
+#else
+    if(get_reference_count(m_wrapper->cobj()) > m_reference_count)
+      detach(m_wrapper);
+#endif
+  }
+
+private:
+  std::mutex m_mutex;
+  std::unique_ptr<Borrowed<T>> m_wrapper;
+  bool m_in_use = false;
+#ifndef CAIROMM_INTRUSIVE_REFPTR
+  RefPtr<T> m_refptr; // one control block shared by all callbacks
+#else
+  unsigned int m_reference_count = 0;
+#endif
+};
+
+// The wrappers passed to the callbacks of one user scaled font, kept in its
+// user data so that a callback doesn't need to allocate new ones.
+struct CallbackWrappers
+{
+  WrapperSlot<ScaledFont> scaled_font;
+  WrapperSlot<Context> context;
+
+  static void destroy(void* data)
+  {
+    delete static_cast<CallbackWrappers*>(data);
+  }
+};
+
+const cairo_user_data_key_t USER_DATA_KEY_CALLBACK_WRAPPERS = {0};
+
+// The scaled font is only set up by init_cb(), which cairo calls before the
+// scaled font can be used by other threads.
+CallbackWrappers* get_callback_wrappers(cairo_scaled_font_t* scaled_font, bool create = false)
+{
+  auto wrappers = static_cast<CallbackWrappers*>(
+    cairo_scaled_font_get_user_data(scaled_font, &USER_DATA_KEY_CALLBACK_WRAPPERS));
+  if(wrappers || !create)
+    return wrappers;
+
+  wrappers = new CallbackWrappers;
+  if(cairo_scaled_font_set_user_data(scaled_font, &USER_DATA_KEY_CALLBACK_WRAPPERS,
+                                     wrappers, &CallbackWrappers::destroy) != CAIRO_STATUS_SUCCESS)
+  {
+    delete wrappers;
+    return nullptr;
+  }
+  return wrappers;
+}
+
+// Gets a wrapper from a slot for the duration of a callback. A new wrapper is
+// allocated if there is no slot or if it is in use.
+template <class T>
+class CallbackWrapper
+{
+public:
+  CallbackWrapper(WrapperSlot<T>* slot, typename T::cobject* cobject)
+  : m_slot(slot)
+  {
+    if(m_slot)
+      m_refptr = m_slot->acquire(cobject);
+    if(!m_refptr)
+      m_refptr = make_refptr_for_instance<T>(new T(cobject));
+  }
+
+  CallbackWrapper(const CallbackWrapper&) = delete;
+  CallbackWrapper& operator=(const CallbackWrapper&) = delete;
+
+  ~CallbackWrapper()
+  {
+    if(m_slot)
+      m_slot->release(m_refptr);
+  }
+
+  const RefPtr<T>& get() const { return m_refptr; }
+
+private:
+  WrapperSlot<T>* m_slot;
+  RefPtr<T> m_refptr;
+};
+
+// Visual C++ 2013 has no thread_local, but supports __declspec(thread) for
+// plain pointers.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define CAIROMM_THREAD_LOCAL __declspec(thread)
+#else
+#define CAIROMM_THREAD_LOCAL thread_local
+#endif
+
+// Set by the default UserFontFace::text_to_glyphs() to ask text_to_glyphs_cb
+// to fall back to unicode_to_glyph() for the current call.
+struct FallbackRequest
+{
+  const UserFontFace* face;
+  bool use_unicode_to_glyph;
+};
+
+// The request of the text_to_glyphs_cb call running in this thread, if any.
+CAIROMM_THREAD_LOCAL FallbackRequest* current_fallback_request = nullptr;
+
+// Makes @a request the current one for the lifetime of the guard. The
+// previous one is restored afterwards, for nested calls.
+class FallbackRequestScope
+{
+public:
+  explicit FallbackRequestScope(FallbackRequest* request)
+  : m_previous(current_fallback_request)
+  {
+    current_fallback_request = request;
+  }
+
+  ~FallbackRequestScope() { current_fallback_request = m_previous; }
+
+  FallbackRequestScope(const FallbackRequestScope&) = delete;
+  FallbackRequestScope& operator=(const FallbackRequestScope&) = delete;
+
+private:
+  FallbackRequest* m_previous;
+};
+
+} // anonymous namespace
+
 static void
 log_uncaught_exception(const char* message = 0)
 {
@@ -142,8 +391,10 @@ UserFontFace::init_cb(cairo_scaled_font_t* scaled_font,
   {
     try
     {
-      return instance->init(make_refptr_for_instance<ScaledFont>(new ScaledFont(scaled_font)),
-                            make_refptr_for_instance<Context>(new Context(cr)),
+      auto wrappers = get_callback_wrappers(scaled_font, true /* create */);
+      CallbackWrapper<ScaledFont> font_wrapper(wrappers ? &wrappers->scaled_font : nullptr, scaled_font);
+      CallbackWrapper<Context> cr_wrapper(wrappers ? &wrappers->context : nullptr, cr);
+      return instance->init(font_wrapper.get(), cr_wrapper.get(),
                             static_cast<FontExtents&>(*metrics));
     }
     catch(const std::exception& ex)
@@ -189,8 +440,9 @@ UserFontFace::unicode_to_glyph_cb(cairo_scaled_font_t *scaled_font,
   {
     try
     {
-      return instance->unicode_to_glyph(make_refptr_for_instance<ScaledFont>(new ScaledFont(scaled_font)),
-                                        unicode, *glyph);
+      auto wrappers = get_callback_wrappers(scaled_font);
+      CallbackWrapper<ScaledFont> font_wrapper(wrappers ? &wrappers->scaled_font : nullptr, scaled_font);
+      return instance->unicode_to_glyph(font_wrapper.get(), unicode, *glyph);
     }
     catch(const std::exception& ex)
     {
@@ -216,6 +468,46 @@ UserFontFace::unicode_to_glyph(const RefPtr<ScaledFont>& /*scaled_font*/,
   return CAIRO_STATUS_SUCCESS;
 }
 
+struct UserFontFace::TextToGlyphsBuffers
+{
+  std::string utf8;
+  std::vector<Glyph> glyphs;
+  std::vector<TextCluster> clusters;
+};
+
+std::unique_ptr<UserFontFace::TextToGlyphsBuffers>
+UserFontFace::take_text_to_glyphs_buffers()
+{
+  std::unique_ptr<TextToGlyphsBuffers> buffers;
+  std::lock_guard<std::mutex> lock(m_text_to_glyphs_buffers_mutex);
+  if(!m_text_to_glyphs_buffers.empty())
+  {
+    buffers = std::move(m_text_to_glyphs_buffers.back());
+    m_text_to_glyphs_buffers.pop_back();
+  }
+  else
+  {
+    // all buffers are in use by other threads, or by a nested call
+    buffers.reset(new TextToGlyphsBuffers());
+  }
+
+  return buffers;
+}
+
+void
+UserFontFace::give_back_text_to_glyphs_buffers(std::unique_ptr<TextToGlyphsBuffers> buffers)
+{
+  std::lock_guard<std::mutex> lock(m_text_to_glyphs_buffers_mutex);
+  try
+  {
+    m_text_to_glyphs_buffers.push_back(std::move(buffers));
+  }
+  catch(...)
+  {
+    // the buffers are just freed
+  }
+}
+
 cairo_status_t
 UserFontFace::text_to_glyphs_cb(cairo_scaled_font_t *scaled_font,
                                 const char *utf8,
@@ -236,49 +528,71 @@ UserFontFace::text_to_glyphs_cb(cairo_scaled_font_t *scaled_font,
   {
     try
     {
-      std::vector<Glyph> glyph_v;
-      std::vector<TextCluster> cluster_v;
-      const std::string utf8_str(utf8, utf8 + utf8_len);
+      // gives the buffers back to the instance, also if an exception is thrown
+      struct BuffersGuard
+      {
+        UserFontFace* instance;
+        std::unique_ptr<TextToGlyphsBuffers> buffers;
+        ~BuffersGuard() { instance->give_back_text_to_glyphs_buffers(std::move(buffers)); }
+      } guard{instance, instance->take_text_to_glyphs_buffers()};
+
+      auto& glyph_v = guard.buffers->glyphs;
+      auto& cluster_v = guard.buffers->clusters;
+      auto& utf8_str = guard.buffers->utf8;
+      glyph_v.clear();
+      cluster_v.clear();
+      utf8_str.assign(utf8, utf8_len);
       auto local_flags = static_cast<TextClusterFlags>(0);
 
-      auto status =
-        instance->text_to_glyphs(make_refptr_for_instance<ScaledFont>(new
-                                                    ScaledFont(scaled_font)),
-                                 utf8_str, glyph_v, cluster_v, local_flags);
+      auto wrappers = get_callback_wrappers(scaled_font);
+      CallbackWrapper<ScaledFont> font_wrapper(wrappers ? &wrappers->scaled_font : nullptr, scaled_font);
+      FallbackRequest fallback = {instance, false};
+      ErrorStatus status = CAIRO_STATUS_SUCCESS;
+      {
+        FallbackRequestScope scope(&fallback);
+        status = instance->text_to_glyphs(font_wrapper.get(),
+                                          utf8_str, glyph_v, cluster_v, local_flags);
+      }
 
       // NOTE: see explanation in text_to_glyphs()
-      if (cairo_font_face_get_user_data(face, &USER_DATA_KEY_DEFAULT_TEXT_TO_GLYPHS))
+      if (fallback.use_unicode_to_glyph)
       {
         *num_glyphs = -1;
         return status;
       }
 
-      // TODO: we re-allocate a new array and pass it back to the caller since
-      // cairo will free the the returned array.  It sucks to do this excessive
-      // allocation and copying, I don't see much alternative besides just
-      // presenting a plain-C API.  If cairo didn't free the list, we could
-      // possibly just pass back a .data() pointer or something...
+      // cairo frees the returned arrays, so the glyphs have to be copied.  If
+      // cairo passes in an array that is big enough, it is used instead of
+      // allocating a new one.
       if(num_glyphs && glyphs)
       {
-        *num_glyphs = glyph_v.size();
-        if(!glyph_v.empty())
+        const int size = glyph_v.size();
+        if(size > 0)
         {
-          *glyphs = cairo_glyph_allocate(glyph_v.size());
+          if(!*glyphs || *num_glyphs < size)
+            *glyphs = cairo_glyph_allocate(size);
+          if(!*glyphs)
+            return CAIRO_STATUS_NO_MEMORY;
           std::copy(glyph_v.begin(), glyph_v.end(), *glyphs);
         }
+        *num_glyphs = size;
       }
       else
         return CAIRO_STATUS_USER_FONT_ERROR;
 
-      // TODO: same for clusters
+      // same for clusters
       if(num_clusters && clusters)
       {
-        *num_clusters = cluster_v.size();
-        if(!cluster_v.empty())
+        const int size = cluster_v.size();
+        if(size > 0)
         {
-          *clusters = cairo_text_cluster_allocate(cluster_v.size());
+          if(!*clusters || *num_clusters < size)
+            *clusters = cairo_text_cluster_allocate(size);
+          if(!*clusters)
+            return CAIRO_STATUS_NO_MEMORY;
           std::copy(cluster_v.begin(), cluster_v.end(), *clusters);
         }
+        *num_clusters = size;
       }
 
       if(cluster_flags)
@@ -307,16 +621,17 @@ UserFontFace::text_to_glyphs(const RefPtr<ScaledFont>& /*scaled_font*/,
                              std::vector<TextCluster>& /*clusters*/,
                              TextClusterFlags& /*cluster_flags*/)
 {
-  // this is a big hack to make up for the fact that we can't easily pass back a
-  // negative value for the size of the glyph array, which is a special value in
-  // the C API that means: "ignore this function and call unicode_to_glyph
-  // instead".  If this default virtual function is ever called, it will set a
-  // non-NULL value in the user_data, which we can read back in the
-  // text_to_glyphs_cb and used as a signal to return -1 for the num_glyphs
-  // parameter.
-  // TODO: Is there a reentrancy requirement, and is this code reentrant?
-  cairo_font_face_set_user_data(cobj(), &USER_DATA_KEY_DEFAULT_TEXT_TO_GLYPHS,
-                                this, 0);
+  // we can't easily pass back a negative value for the size of the glyph
+  // array, which is a special value in the C API that means: "ignore this
+  // function and call unicode_to_glyph instead".  So this default virtual
+  // function marks the request of the text_to_glyphs_cb call running in this
+  // thread, and text_to_glyphs_cb then returns -1 for the num_glyphs
+  // parameter.  The request belongs to this one call, so it works when
+  // several threads use this font face, and when a derived class only calls
+  // this function for some strings, without any lock.
+  auto request = current_fallback_request;
+  if(request && request->face == this)
+    request->use_unicode_to_glyph = true;
   return CAIRO_STATUS_SUCCESS;
 }
 
@@ -335,9 +650,59 @@ UserFontFace::render_glyph_cb(cairo_scaled_font_t  *scaled_font,
   {
     try
     {
-      return instance->render_glyph(make_refptr_for_instance<ScaledFont>(new ScaledFont(scaled_font)),
-                                    glyph, make_refptr_for_instance<Context>(new Context(cr)),
-                                    static_cast<TextExtents&>(*metrics));
+      auto wrappers = get_callback_wrappers(scaled_font);
+      CallbackWrapper<ScaledFont> font_wrapper(wrappers ? &wrappers->scaled_font : nullptr, scaled_font);
+
+      auto atlas = std::atomic_load(&instance->m_glyph_atlas);
+      if(!atlas)
+      {
+        CallbackWrapper<Context> cr_wrapper(wrappers ? &wrappers->context : nullptr, cr);
+        return instance->render_glyph(font_wrapper.get(), glyph, cr_wrapper.get(),
+                                      static_cast<TextExtents&>(*metrics));
+      }
+
+      Matrix scale;
+      cairo_scaled_font_get_scale_matrix(scaled_font, &scale);
+      std::unique_ptr<cairo_font_options_t, decltype(&cairo_font_options_destroy)>
+        options(cairo_font_options_create(), &cairo_font_options_destroy);
+      cairo_scaled_font_get_font_options(scaled_font, options.get());
+      const Private::GlyphAtlas::Key key = {glyph, scale.xx, scale.yx, scale.xy, scale.yy,
+                                            cairo_font_options_get_antialias(options.get())};
+
+      // the atlas draws in device space, where the glyph origin is (0, 0)
+      cairo_save(cr);
+      cairo_identity_matrix(cr);
+      if(atlas->draw(key, cr, static_cast<TextExtents&>(*metrics)))
+      {
+        cairo_restore(cr);
+        return CAIRO_STATUS_SUCCESS;
+      }
+
+      // draw the glyph once, in device space, and keep the result
+      std::unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)>
+        recording(cairo_recording_surface_create(CAIRO_CONTENT_ALPHA, nullptr), &cairo_surface_destroy);
+      ErrorStatus status = CAIRO_STATUS_SUCCESS;
+      {
+        std::unique_ptr<cairo_t, decltype(&cairo_destroy)>
+          recording_cr(cairo_create(recording.get()), &cairo_destroy);
+        // set up like the context that cairo passes to render_glyph()
+        scale.x0 = scale.y0 = 0;
+        auto inverse = scale;
+        if(cairo_matrix_invert(&inverse) == CAIRO_STATUS_SUCCESS)
+          cairo_set_matrix(recording_cr.get(), &scale);
+        cairo_set_font_size(recording_cr.get(), 1.0);
+        cairo_set_font_options(recording_cr.get(), options.get());
+        cairo_set_source_rgb(recording_cr.get(), 1.0, 1.0, 1.0);
+        CallbackWrapper<Context> cr_wrapper(wrappers ? &wrappers->context : nullptr, recording_cr.get());
+        status = instance->render_glyph(font_wrapper.get(), glyph, cr_wrapper.get(),
+                                        static_cast<TextExtents&>(*metrics));
+      }
+
+      if(status == CAIRO_STATUS_SUCCESS &&
+         !atlas->insert_and_draw(key, recording.get(), static_cast<TextExtents&>(*metrics), cr))
+        cairo_mask_surface(cr, recording.get(), 0, 0); // too big for the atlas
+      cairo_restore(cr);
+      return status;
     }
     catch(const std::exception& ex)
     {
@@ -375,6 +740,25 @@ UserFontFace::~UserFontFace()
 {
 }
 
+void UserFontFace::enable_glyph_atlas(int page_width, int page_height, unsigned int max_pages)
+{
+  if(page_width <= 0 || page_height <= 0 || max_pages == 0)
+    throw_exception(CAIRO_STATUS_INVALID_SIZE);
+
+  std::atomic_store(&m_glyph_atlas,
+                    std::make_shared<Private::GlyphAtlas>(page_width, page_height, max_pages));
+}
+
+void UserFontFace::disable_glyph_atlas()
+{
+  std::atomic_store(&m_glyph_atlas, std::shared_ptr<Private::GlyphAtlas>());
+}
+
+bool UserFontFace::get_glyph_atlas_enabled() const
+{
+  return static_cast<bool>(std::atomic_load(&m_glyph_atlas));
+}
+
 #ifdef CAIRO_HAS_FT_FONT
 
 RefPtr<FtFontFace>
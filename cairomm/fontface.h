@@ -19,6 +19,8 @@
 #ifndef __CAIROMM_FONTFACE_H
 #define __CAIROMM_FONTFACE_H
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <cairomm/enums.h>
@@ -37,6 +39,13 @@ namespace Cairo
 class ScaledFont;
 class Context;
 
+#ifndef DOXYGEN_IGNORE_THIS
+namespace Private
+{
+class GlyphAtlas;
+}
+#endif //DOXYGEN_IGNORE_THIS
+
 /**
  * A FontFace represents a particular font at a particular weight, slant, and
  * other characteristic but no size, transformation, or size.
@@ -202,6 +211,10 @@ protected:
  * intend to render text with that font.  A future release of cairomm will fix
  * this requirement, but that will require ABI-incompatible changes.
  *
+ * The ScaledFont and Context objects passed to the virtual functions are
+ * reused by later calls for the same scaled font, so that rendering a glyph
+ * does not allocate new wrappers. It is still safe to keep a RefPtr to them.
+ *
  * @since 1.8
  */
 class UserFontFace : public FontFace
@@ -210,6 +223,40 @@ public:
 
   ~UserFontFace() override;
 
+  /** Enables the glyph atlas of this font face.
+   *
+   * Normally render_glyph() is called for each glyph of each ScaledFont, so
+   * the glyphs are drawn again whenever cairo creates a new scaled font for
+   * another size or transformation, or recreates one it has dropped. With the
+   * glyph atlas, each glyph is drawn only once for each scale and antialiasing
+   * mode. The result is kept as an 8-bit alpha image in pages that are shared
+   * by all scaled fonts of this face, and glyphs are then drawn by masking with
+   * that image.
+   *
+   * This is meant for fonts with complex vector glyphs, such as icon fonts. As
+   * glyphs are drawn from images, they are not positioned with subpixel
+   * precision. render_glyph() must only depend on the glyph and on the scale of
+   * the ScaledFont, and glyphs bigger than a page are drawn without the atlas.
+   *
+   * When all pages are full, the least recently used page is dropped. It is
+   * safe to draw with the font face from several threads.
+   *
+   * @param page_width the width of each page of the atlas, in pixels.
+   * @param page_height the height of each page of the atlas, in pixels.
+   * @param max_pages the maximum number of pages.
+   *
+   * @exception Cairo::logic_error if a size is not positive.
+   */
+  void enable_glyph_atlas(int page_width = 1024, int page_height = 1024, unsigned int max_pages = 4);
+
+  /** Disables the glyph atlas and frees its pages. Glyphs that cairo has
+   * already cached are not drawn again. See enable_glyph_atlas().
+   */
+  void disable_glyph_atlas();
+
+  /** Checks whether the glyph atlas is enabled. See enable_glyph_atlas(). */
+  bool get_glyph_atlas_enabled() const;
+
   /*
   static RefPtr<UserFontFace> create();
   static RefPtr<UserFontFace> create(cairo_font_face_t* cobject, bool has_reference = false);
@@ -338,7 +385,9 @@ protected:
    * If clusters is not empty, cluster mapping should be computed.
    *
    * If you do not override this virtual function in your derived class, 
-   * the unicode_to_glyph function is used instead.
+   * the unicode_to_glyph function is used instead. An override can also call
+   * UserFontFace::text_to_glyphs() with the same arguments, to use
+   * unicode_to_glyph for some strings only.
    *
    * Note: While cairo does not impose any limitation on glyph indices, some
    * applications may assume that a glyph index fits in a 16-bit unsigned
@@ -391,6 +440,20 @@ private:
                      cairo_text_cluster_t **clusters,
                      int *num_clusters,
                      cairo_text_cluster_flags_t *cluster_flags);
+
+#ifndef DOXYGEN_IGNORE_THIS
+  // The arguments passed to text_to_glyphs() by text_to_glyphs_cb(), kept so
+  // that their storage can be reused by later calls.
+  struct TextToGlyphsBuffers;
+  std::unique_ptr<TextToGlyphsBuffers> take_text_to_glyphs_buffers();
+  void give_back_text_to_glyphs_buffers(std::unique_ptr<TextToGlyphsBuffers> buffers);
+
+  std::mutex m_text_to_glyphs_buffers_mutex;
+  std::vector<std::unique_ptr<TextToGlyphsBuffers>> m_text_to_glyphs_buffers;
+
+  // Accessed with std::atomic_load() and std::atomic_store().
+  std::shared_ptr<Private::GlyphAtlas> m_glyph_atlas;
+#endif //DOXYGEN_IGNORE_THIS
 };
 
 
@@ -0,0 +1,260 @@
+/* Copyright (C) 2026 The cairomm Development Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <cairomm/glyphatlas_private.h>
+#include <cmath>
+#include <functional>
+
+namespace Cairo
+{
+
+namespace Private
+{
+
+namespace
+{
+
+inline void hash_combine(std::size_t& seed, std::size_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+// Leaves a row and a column of transparent pixels between glyphs, so that
+// filtering at the edge of a glyph doesn't pick up its neighbours.
+const int GLYPH_PADDING = 1;
+
+} // anonymous namespace
+
+bool GlyphAtlas::Key::operator==(const Key& other) const
+{
+  return glyph == other.glyph && xx == other.xx && yx == other.yx &&
+    xy == other.xy && yy == other.yy && antialias == other.antialias;
+}
+
+std::size_t GlyphAtlas::KeyHash::operator()(const Key& key) const
+{
+  std::hash<double> hash_double;
+  auto seed = std::hash<unsigned long>()(key.glyph);
+  hash_combine(seed, hash_double(key.xx));
+  hash_combine(seed, hash_double(key.yx));
+  hash_combine(seed, hash_double(key.xy));
+  hash_combine(seed, hash_double(key.yy));
+  hash_combine(seed, static_cast<std::size_t>(key.antialias));
+  return seed;
+}
+
+GlyphAtlas::GlyphAtlas(int page_width, int page_height, unsigned int max_pages)
+: m_page_width(page_width),
+  m_page_height(page_height),
+  m_max_pages(max_pages),
+  m_clock(0)
+{
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+  for(auto& entry : m_entries)
+  {
+    if(entry.second.image)
+      cairo_surface_destroy(entry.second.image);
+  }
+
+  for(auto& page : m_pages)
+    cairo_surface_destroy(page.surface);
+}
+
+bool GlyphAtlas::draw(const Key& key, cairo_t* cr, TextExtents& metrics)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto found = m_entries.find(key);
+  if(found == m_entries.end())
+    return false;
+
+  metrics = found->second.metrics;
+  draw_entry(found->second, cr);
+  return true;
+}
+
+bool GlyphAtlas::insert_and_draw(const Key& key, cairo_surface_t* recording,
+  const TextExtents& metrics, cairo_t* cr)
+{
+  double x = 0, y = 0, width = 0, height = 0;
+  cairo_recording_surface_ink_extents(recording, &x, &y, &width, &height);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto found = m_entries.find(key);
+  if(found != m_entries.end())
+  {
+    // another thread rendered the same glyph meanwhile
+    draw_entry(found->second, cr);
+    return true;
+  }
+
+  Entry entry;
+  entry.page = 0;
+  entry.image = nullptr;
+  entry.x = 0;
+  entry.y = 0;
+  entry.metrics = metrics;
+
+  // glyphs without ink, such as spaces, only need their metrics
+  if(width > 0 && height > 0)
+  {
+    const auto left = std::floor(x);
+    const auto top = std::floor(y);
+    const auto image_width = static_cast<int>(std::ceil(x + width) - left);
+    const auto image_height = static_cast<int>(std::ceil(y + height) - top);
+
+    RectangleInt rectangle;
+    if(!allocate(image_width, image_height, entry.page, rectangle))
+      return false;
+
+    auto page_cr = cairo_create(m_pages[entry.page].surface);
+    cairo_rectangle(page_cr, rectangle.x, rectangle.y, rectangle.width, rectangle.height);
+    cairo_clip(page_cr);
+    cairo_set_source_surface(page_cr, recording, rectangle.x - left, rectangle.y - top);
+    cairo_paint(page_cr);
+    cairo_destroy(page_cr);
+    cairo_surface_flush(m_pages[entry.page].surface);
+
+    entry.image = cairo_surface_create_for_rectangle(m_pages[entry.page].surface,
+      rectangle.x, rectangle.y, rectangle.width, rectangle.height);
+    entry.x = left;
+    entry.y = top;
+  }
+
+  draw_entry(m_entries.emplace(key, entry).first->second, cr);
+  return true;
+}
+
+void GlyphAtlas::draw_entry(Entry& entry, cairo_t* cr)
+{
+  if(!entry.image)
+    return;
+
+  m_pages[entry.page].last_used = ++m_clock;
+  cairo_mask_surface(cr, entry.image, entry.x, entry.y);
+}
+
+bool GlyphAtlas::allocate(int width, int height, std::size_t& page, RectangleInt& rectangle)
+{
+  if(width + GLYPH_PADDING > m_page_width || height + GLYPH_PADDING > m_page_height)
+    return false;
+
+  for(page = 0; page < m_pages.size(); ++page)
+  {
+    if(allocate_in_page(m_pages[page], width, height, rectangle))
+      return true;
+  }
+
+  if(m_pages.size() < m_max_pages)
+  {
+    Page new_page;
+    new_page.surface = cairo_image_surface_create(CAIRO_FORMAT_A8, m_page_width, m_page_height);
+    if(cairo_surface_status(new_page.surface) != CAIRO_STATUS_SUCCESS)
+    {
+      cairo_surface_destroy(new_page.surface);
+      return false;
+    }
+    new_page.used_height = 0;
+    new_page.last_used = m_clock;
+    m_pages.push_back(new_page);
+    page = m_pages.size() - 1;
+  }
+  else
+  {
+    page = 0;
+    for(std::size_t i = 1; i < m_pages.size(); ++i)
+    {
+      if(m_pages[i].last_used < m_pages[page].last_used)
+        page = i;
+    }
+    if(!reset_page(page))
+      return false;
+  }
+
+  return allocate_in_page(m_pages[page], width, height, rectangle);
+}
+
+bool GlyphAtlas::allocate_in_page(Page& page, int width, int height, RectangleInt& rectangle)
+{
+  const auto padded_width = width + GLYPH_PADDING;
+  const auto padded_height = height + GLYPH_PADDING;
+
+  // use the lowest shelf that is high enough, to waste the least space
+  Shelf* best = nullptr;
+  for(auto& shelf : page.shelves)
+  {
+    if(padded_height <= shelf.height && shelf.used_width + padded_width <= m_page_width &&
+       (!best || shelf.height < best->height))
+      best = &shelf;
+  }
+
+  if(!best)
+  {
+    if(page.used_height + padded_height > m_page_height)
+      return false;
+
+    page.shelves.push_back(Shelf{page.used_height, padded_height, 0});
+    page.used_height += padded_height;
+    best = &page.shelves.back();
+  }
+
+  rectangle.x = best->used_width;
+  rectangle.y = best->y;
+  rectangle.width = width;
+  rectangle.height = height;
+  best->used_width += padded_width;
+  return true;
+}
+
+bool GlyphAtlas::reset_page(std::size_t page)
+{
+  for(auto i = m_entries.begin(); i != m_entries.end();)
+  {
+    // glyphs without ink are dropped too, so that they can't pile up
+    if(i->second.page == page || !i->second.image)
+    {
+      if(i->second.image)
+        cairo_surface_destroy(i->second.image);
+      i = m_entries.erase(i);
+    }
+    else
+      ++i;
+  }
+
+  // cairo may still refer to the old surface, so it is replaced instead of
+  // cleared
+  auto& evicted = m_pages[page];
+  auto surface = cairo_image_surface_create(CAIRO_FORMAT_A8, m_page_width, m_page_height);
+  cairo_surface_destroy(evicted.surface);
+  evicted.surface = surface;
+  evicted.shelves.clear();
+  evicted.last_used = m_clock;
+
+  // a page that could not be created is left full, until it is evicted again
+  const auto ok = cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS;
+  evicted.used_height = ok ? 0 : m_page_height;
+  return ok;
+}
+
+} // namespace Private
+
+} // namespace Cairo
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,115 @@
+/* Copyright (C) 2026 The cairomm Development Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __CAIROMM_GLYPHATLAS_PRIVATE_H
+#define __CAIROMM_GLYPHATLAS_PRIVATE_H
+
+#include <cairomm/types.h>
+#include <cairo.h>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Cairo
+{
+
+namespace Private
+{
+
+// Rasterized glyphs of a UserFontFace, kept in A8 image pages.
+//
+// Each glyph is stored once per glyph index, scale and antialiasing mode. The
+// glyphs are packed into shelves in each page. When all pages are full, the
+// least recently used page is dropped as a whole and replaced by a new one,
+// so that glyphs that cairo still refers to are never overwritten.
+class GlyphAtlas
+{
+public:
+  struct Key
+  {
+    unsigned long glyph;
+    double xx, yx, xy, yy; // the scale matrix, without translation
+    int antialias;
+
+    bool operator==(const Key& other) const;
+  };
+
+  GlyphAtlas(int page_width, int page_height, unsigned int max_pages);
+  ~GlyphAtlas();
+
+  GlyphAtlas(const GlyphAtlas&) = delete;
+  GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+  // Draws the glyph for @a key to @a cr, which must be in device space, and
+  // sets @a metrics. Returns false if the glyph is not in the atlas.
+  bool draw(const Key& key, cairo_t* cr, TextExtents& metrics);
+
+  // Rasterizes @a recording, which contains the glyph drawn in device space,
+  // into the atlas, and then draws it like draw(). Returns false if the glyph
+  // is too big for a page.
+  bool insert_and_draw(const Key& key, cairo_surface_t* recording,
+    const TextExtents& metrics, cairo_t* cr);
+
+private:
+  struct Entry
+  {
+    std::size_t page;
+    cairo_surface_t* image; // a subsurface of the page
+    double x, y; // where the image goes, relative to the glyph origin
+    TextExtents metrics;
+  };
+
+  struct Shelf
+  {
+    int y, height, used_width;
+  };
+
+  struct Page
+  {
+    cairo_surface_t* surface;
+    std::vector<Shelf> shelves;
+    int used_height;
+    unsigned long long last_used;
+  };
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  void draw_entry(Entry& entry, cairo_t* cr);
+  bool allocate(int width, int height, std::size_t& page, RectangleInt& rectangle);
+  bool allocate_in_page(Page& page, int width, int height, RectangleInt& rectangle);
+  bool reset_page(std::size_t page);
+
+  std::mutex m_mutex;
+  int m_page_width, m_page_height;
+  unsigned int m_max_pages;
+  unsigned long long m_clock;
+  std::vector<Page> m_pages;
+  std::unordered_map<Key, Entry, KeyHash> m_entries;
+};
+
+} // namespace Private
+
+} // namespace Cairo
+
+#endif // __CAIROMM_GLYPHATLAS_PRIVATE_H
+
+// vim: ts=2 sw=2 et
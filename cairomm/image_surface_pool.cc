@@ -0,0 +1,242 @@
+/* Copyright (C) 2026 The cairomm Development Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <cairomm/image_surface_pool.h>
+#include <cairomm/private.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace Cairo
+{
+
+struct ImageSurfacePool::State
+{
+  ~State();
+
+  std::mutex mutex;
+
+  //Free buffers, by size class.
+  std::map<std::size_t, std::vector<unsigned char*>> buckets;
+
+  std::size_t max_bytes_retained;
+  Statistics statistics;
+};
+
+namespace
+{
+
+const std::size_t alignment = 64;
+
+//Allocates size bytes aligned to alignment. The offset from the start of
+//the malloc()ed block is kept in the byte before the returned pointer.
+unsigned char* allocate_aligned(std::size_t size)
+{
+  auto raw = static_cast<unsigned char*>(std::malloc(size + alignment));
+  if(!raw)
+    return nullptr;
+
+  const auto offset = alignment - reinterpret_cast<std::uintptr_t>(raw) % alignment;
+  auto aligned = raw + offset;
+  aligned[-1] = static_cast<unsigned char>(offset);
+  return aligned;
+}
+
+void free_aligned(unsigned char* aligned)
+{
+  std::free(aligned - aligned[-1]);
+}
+
+//Rounds size up to the next power of two or 1.5 times a power of two, so
+//that a buffer wastes at most a third of its size.
+std::size_t get_size_class(std::size_t size)
+{
+  std::size_t size_class = 4096;
+  while(size_class < size)
+  {
+    const auto between = size_class + size_class / 2;
+    if(between >= size)
+      return between;
+    size_class *= 2;
+  }
+  return size_class;
+}
+
+//Stored as user data of each pooled surface.
+struct PooledBuffer
+{
+  std::weak_ptr<ImageSurfacePool::State> pool;
+  unsigned char* data;
+  std::size_t size;
+};
+
+const cairo_user_data_key_t USER_DATA_KEY_POOLED_BUFFER = {0};
+
+void free_buffers(ImageSurfacePool::State& state, std::size_t max_bytes_retained)
+{
+  //Frees the largest buffers first.
+  auto& statistics = state.statistics;
+  for(auto bucket = state.buckets.rbegin();
+    bucket != state.buckets.rend() && statistics.bytes_retained > max_bytes_retained;
+    ++bucket)
+  {
+    auto& buffers = bucket->second;
+    while(!buffers.empty() && statistics.bytes_retained > max_bytes_retained)
+    {
+      free_aligned(buffers.back());
+      buffers.pop_back();
+      statistics.bytes_retained -= bucket->first;
+    }
+  }
+}
+
+void release_buffer(void* data)
+{
+  std::unique_ptr<PooledBuffer> buffer(static_cast<PooledBuffer*>(data));
+  auto state = buffer->pool.lock();
+  if(state)
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    auto& statistics = state->statistics;
+    statistics.bytes_in_use -= buffer->size;
+    if(statistics.bytes_retained + buffer->size <= state->max_bytes_retained)
+    {
+      state->buckets[buffer->size].push_back(buffer->data);
+      statistics.bytes_retained += buffer->size;
+      return;
+    }
+  }
+
+  free_aligned(buffer->data);
+}
+
+} //anonymous namespace
+
+//A surface that is destroyed while the pool is being destroyed can still
+//return its buffer to the State, so the State frees the buffers, not the pool.
+ImageSurfacePool::State::~State()
+{
+  free_buffers(*this, 0);
+}
+
+ImageSurfacePool::ImageSurfacePool(std::size_t max_bytes_retained)
+: m_state(std::make_shared<State>())
+{
+  m_state->max_bytes_retained = max_bytes_retained;
+  m_state->statistics = Statistics{0, 0, 0, 0};
+}
+
+ImageSurfacePool::~ImageSurfacePool()
+{
+}
+
+RefPtr<ImageSurface> ImageSurfacePool::create(Format format, int width, int height, bool clear)
+{
+  auto stride = cairo_format_stride_for_width(static_cast<cairo_format_t>(format), width);
+  if(stride < 0 || height < 0)
+    throw_exception(CAIRO_STATUS_INVALID_SIZE);
+
+  stride = (stride + alignment - 1) / alignment * alignment;
+  const auto used_size = static_cast<std::size_t>(stride) * height;
+  const auto size = get_size_class(used_size);
+
+  unsigned char* data = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    auto& statistics = m_state->statistics;
+    auto bucket = m_state->buckets.find(size);
+    if(bucket != m_state->buckets.end() && !bucket->second.empty())
+    {
+      data = bucket->second.back();
+      bucket->second.pop_back();
+      statistics.bytes_retained -= size;
+      ++statistics.hits;
+    }
+    else
+      ++statistics.misses;
+
+    statistics.bytes_in_use += size;
+  }
+
+  std::unique_ptr<PooledBuffer> buffer(new PooledBuffer{m_state, data, size});
+  if(!buffer->data)
+  {
+    buffer->data = allocate_aligned(size);
+    if(!buffer->data)
+    {
+      std::lock_guard<std::mutex> lock(m_state->mutex);
+      m_state->statistics.bytes_in_use -= size;
+      throw_exception(CAIRO_STATUS_NO_MEMORY);
+    }
+  }
+
+  if(clear)
+    std::memset(buffer->data, 0, used_size);
+
+  auto cobject = cairo_image_surface_create_for_data(buffer->data,
+    static_cast<cairo_format_t>(format), width, height, stride);
+  auto status = cairo_surface_status(cobject);
+  if(status == CAIRO_STATUS_SUCCESS)
+  {
+    status = cairo_surface_set_user_data(cobject, &USER_DATA_KEY_POOLED_BUFFER,
+      buffer.get(), &release_buffer);
+  }
+
+  if(status != CAIRO_STATUS_SUCCESS)
+  {
+    cairo_surface_destroy(cobject);
+    release_buffer(buffer.release());
+    throw_exception(status);
+  }
+
+  //The surface owns the buffer now.
+  buffer.release();
+  return make_cached_refptr_for_instance<ImageSurface>(new ImageSurface(cobject, true /* has reference */));
+}
+
+void ImageSurfacePool::set_max_bytes_retained(std::size_t max_bytes_retained)
+{
+  std::lock_guard<std::mutex> lock(m_state->mutex);
+  m_state->max_bytes_retained = max_bytes_retained;
+  free_buffers(*m_state, max_bytes_retained);
+}
+
+std::size_t ImageSurfacePool::get_max_bytes_retained() const
+{
+  std::lock_guard<std::mutex> lock(m_state->mutex);
+  return m_state->max_bytes_retained;
+}
+
+void ImageSurfacePool::trim()
+{
+  std::lock_guard<std::mutex> lock(m_state->mutex);
+  free_buffers(*m_state, 0);
+}
+
+ImageSurfacePool::Statistics ImageSurfacePool::get_statistics() const
+{
+  std::lock_guard<std::mutex> lock(m_state->mutex);
+  return m_state->statistics;
+}
+
+} //namespace Cairo
+
+// vim: ts=2 sw=2 et
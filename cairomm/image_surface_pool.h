@@ -0,0 +1,117 @@
+/* Copyright (C) 2026 The cairomm Development Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __CAIROMM_IMAGE_SURFACE_POOL_H
+#define __CAIROMM_IMAGE_SURFACE_POOL_H
+
+#include <cairomm/surface.h>
+#include <cstddef>
+#include <memory>
+
+namespace Cairo
+{
+
+/**
+ * Creates ImageSurface objects whose pixel buffers are recycled.
+ *
+ * ImageSurface::create(Format, int, int) allocates a new buffer for every
+ * surface. A pool instead keeps the buffers of destroyed surfaces and hands
+ * them out again, which avoids repeated allocations and page faults when
+ * many short-lived surfaces are created.
+ *
+ * Buffers are grouped in size classes, so a buffer can be reused for a
+ * surface of a slightly different size. The start of each buffer and each row
+ * of pixels is aligned to 64 bytes.
+ *
+ * A buffer returns to the pool when its cairo surface is destroyed, that is
+ * when the last RefPtr to the surface is dropped and cairo no longer uses it,
+ * for instance as the source of a Pattern. If the pool has already been
+ * destroyed by then, the buffer is freed instead.
+ *
+ * An ImageSurfacePool may be used from several threads at once.
+ */
+class ImageSurfacePool
+{
+public:
+  /** Counters describing the use of an ImageSurfacePool. */
+  struct Statistics
+  {
+    /// The number of surfaces created with a recycled buffer.
+    unsigned long long hits;
+    /// The number of surfaces for which a new buffer was allocated.
+    unsigned long long misses;
+    /// The size of the buffers that are kept for reuse, in bytes.
+    std::size_t bytes_retained;
+    /// The size of the buffers used by existing surfaces, in bytes.
+    std::size_t bytes_in_use;
+  };
+
+  /** Creates an empty pool.
+   *
+   * @param max_bytes_retained the maximum size of the buffers kept for reuse.
+   * Buffers that would exceed it are freed when their surface is destroyed.
+   */
+  explicit ImageSurfacePool(std::size_t max_bytes_retained = 64 * 1024 * 1024);
+
+  ImageSurfacePool(const ImageSurfacePool&) = delete;
+  ImageSurfacePool& operator=(const ImageSurfacePool&) = delete;
+
+  /** Frees the buffers kept for reuse. Surfaces created by the pool stay
+   * valid.
+   */
+  virtual ~ImageSurfacePool();
+
+  /** Creates an image surface, reusing a buffer from the pool if possible.
+   *
+   * @param format format of pixels in the surface to create
+   * @param width width of the surface, in pixels
+   * @param height height of the surface, in pixels
+   * @param clear whether to clear the pixels to transparent black, as
+   * ImageSurface::create(Format, int, int) does. Pass false if all the pixels
+   * will be overwritten anyway.
+   * @return a RefPtr to the newly created surface.
+   */
+  RefPtr<ImageSurface> create(Format format, int width, int height, bool clear = true);
+
+  /** Sets the maximum size of the buffers kept for reuse, and frees buffers
+   * until it is respected.
+   */
+  void set_max_bytes_retained(std::size_t max_bytes_retained);
+
+  /** Gets the maximum size of the buffers kept for reuse. */
+  std::size_t get_max_bytes_retained() const;
+
+  /** Frees all the buffers kept for reuse. */
+  void trim();
+
+  /** Gets the current statistics of the pool. */
+  Statistics get_statistics() const;
+
+#ifndef DOXYGEN_IGNORE_THIS
+  struct State;
+#endif //DOXYGEN_IGNORE_THIS
+
+protected:
+  std::shared_ptr<State> m_state;
+};
+
+} // namespace Cairo
+
+#endif //__CAIROMM_IMAGE_SURFACE_POOL_H
+
+// vim: ts=2 sw=2 et
@@ -17,10 +17,71 @@
  */
 #include <cairomm/matrix.h>
 #include <cairomm/private.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CAIROMM_MATRIX_SSE2 1
+#include <emmintrin.h>
+#endif
 
 namespace Cairo
 {
 
+namespace
+{
+
+//All kernels compute x * xx + y * xy + x0 and x * yx + y * yy + y0 with the
+//same operations in the same order as cairo_matrix_transform_point(). The
+//compiler may still contract them into fused multiply-adds, here or in cairo,
+//so the results can differ from it in the last bits.
+//
+//The points are pairs of doubles that are stride bytes apart, so that the
+//positions of glyphs can be transformed in place.
+
+#ifndef CAIROMM_MATRIX_SSE2
+void transform_points_scalar(const Matrix& m, char* first, std::size_t stride, std::size_t n)
+{
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    auto point = reinterpret_cast<double*>(first + i * stride);
+    const auto x = point[0];
+    const auto y = point[1];
+    point[0] = m.xx * x + m.xy * y + m.x0;
+    point[1] = m.yx * x + m.yy * y + m.y0;
+  }
+}
+#endif //CAIROMM_MATRIX_SSE2
+
+#ifdef CAIROMM_MATRIX_SSE2
+void transform_points_sse2(const Matrix& m, char* first, std::size_t stride, std::size_t n)
+{
+  const auto x_factors = _mm_set_pd(m.yx, m.xx);
+  const auto y_factors = _mm_set_pd(m.yy, m.xy);
+  const auto offsets = _mm_set_pd(m.y0, m.x0);
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    auto point = reinterpret_cast<double*>(first + i * stride);
+    const auto xy = _mm_loadu_pd(point);
+    const auto x = _mm_unpacklo_pd(xy, xy);
+    const auto y = _mm_unpackhi_pd(xy, xy);
+    const auto result = _mm_add_pd(
+      _mm_add_pd(_mm_mul_pd(x, x_factors), _mm_mul_pd(y, y_factors)), offsets);
+    _mm_storeu_pd(point, result);
+  }
+}
+#endif //CAIROMM_MATRIX_SSE2
+
+void transform_points_strided(const Matrix& m, char* first, std::size_t stride, std::size_t n)
+{
+#ifdef CAIROMM_MATRIX_SSE2
+  transform_points_sse2(m, first, stride, n);
+#else
+  transform_points_scalar(m, first, stride, n);
+#endif
+}
+
+} //anonymous namespace
+
 Matrix::Matrix()
 {
 }
@@ -95,6 +156,55 @@ void Matrix::transform_point(double& x, double& y) const
   cairo_matrix_transform_point(this, &x, &y);
 }
 
+void Matrix::transform_points(double* xy, std::size_t n_points) const
+{
+  transform_points_strided(*this, reinterpret_cast<char*>(xy), 2 * sizeof(double), n_points);
+}
+
+void Matrix::transform_glyphs(Glyph* glyphs, std::size_t n_glyphs) const
+{
+  if(n_glyphs)
+    transform_points_strided(*this, reinterpret_cast<char*>(&glyphs[0].x), sizeof(Glyph), n_glyphs);
+}
+
+void Matrix::transform_rectangles(Rectangle* rects, std::size_t n_rects) const
+{
+  //The corners are transformed in batches, to use the same kernels.
+  const std::size_t batch_size = 64;
+  double corners[batch_size * 8];
+  for(std::size_t first = 0; first < n_rects; first += batch_size)
+  {
+    const auto n = std::min(batch_size, n_rects - first);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      const auto& rect = rects[first + i];
+      const double right = rect.x + rect.width;
+      const double bottom = rect.y + rect.height;
+      double* corner = corners + i * 8;
+      corner[0] = rect.x; corner[1] = rect.y;
+      corner[2] = right;  corner[3] = rect.y;
+      corner[4] = rect.x; corner[5] = bottom;
+      corner[6] = right;  corner[7] = bottom;
+    }
+
+    transform_points(corners, n * 4);
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      const double* corner = corners + i * 8;
+      const auto x1 = std::min(std::min(corner[0], corner[2]), std::min(corner[4], corner[6]));
+      const auto x2 = std::max(std::max(corner[0], corner[2]), std::max(corner[4], corner[6]));
+      const auto y1 = std::min(std::min(corner[1], corner[3]), std::min(corner[5], corner[7]));
+      const auto y2 = std::max(std::max(corner[1], corner[3]), std::max(corner[5], corner[7]));
+      auto& rect = rects[first + i];
+      rect.x = x1;
+      rect.y = y1;
+      rect.width = x2 - x1;
+      rect.height = y2 - y1;
+    }
+  }
+}
+
 Matrix operator*(const Matrix& a, const Matrix& b)
 {
   Matrix m;
@@ -18,7 +18,9 @@
 #ifndef __CAIROMM_MATRIX_H
 #define __CAIROMM_MATRIX_H
 
+#include <cairomm/types.h>
 #include <cairo.h>
+#include <cstddef>
 
 namespace Cairo
 {
@@ -157,6 +159,39 @@ public:
    * @param y Y position. An in/out parameter
    */
   void transform_point(double& x, double& y) const;
+
+  /** Transforms each of the given points by this matrix.
+   *
+   * The results are the same as calling transform_point() for each point,
+   * but without a call into cairo for each point, and with SSE2 where it
+   * is available. They may differ in the last bits if the compiler uses fused
+   * multiply-adds for only one of them.
+   *
+   * @param xy	the coordinates of the points as x,y pairs: x0, y0, x1, y1, ...
+   * An in/out parameter.
+   * @param n_points	the number of points, which is half the number of
+   * doubles in @a xy.
+   */
+  void transform_points(double* xy, std::size_t n_points) const;
+
+  /** Transforms the position of each of the given glyphs by this matrix, in
+   * the same way as transform_points(). The glyph indices are not changed.
+   *
+   * @param glyphs	the glyphs. An in/out parameter.
+   * @param n_glyphs	the number of glyphs.
+   */
+  void transform_glyphs(Glyph* glyphs, std::size_t n_glyphs) const;
+
+  /** Replaces each of the given rectangles by the bounding box of the
+   * rectangle transformed by this matrix. The bounding box is exact if the
+   * matrix only scales and translates, or rotates by multiples of 90 degrees.
+   *
+   * The corners are transformed in the same way as by transform_points().
+   *
+   * @param rects	the rectangles. An in/out parameter.
+   * @param n_rects	the number of rectangles.
+   */
+  void transform_rectangles(Rectangle* rects, std::size_t n_rects) const;
 };
 
 /** Returns a Matrix initialized to the identity matrix
@@ -18,73 +18,593 @@
 
 #include <cairomm/path.h>
 #include <cairomm/private.h>
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <utility>
 
 namespace Cairo
 {
 
-/*
+namespace
+{
+
+//cairo has no cairo_path_copy(), so copies are allocated by cairomm and must
+//be freed with free_path_copy() rather than cairo_path_destroy().
+cairo_path_t* copy_path(const cairo_path_t* src)
+{
+  auto result = new cairo_path_t;
+  result->status = src->status;
+  result->num_data = src->num_data;
+  result->data = nullptr;
+  if(src->num_data > 0)
+  {
+    result->data = new cairo_path_data_t[src->num_data];
+    std::copy(src->data, src->data + src->num_data, result->data);
+  }
+  return result;
+}
+
+cairo_path_t* create_empty_path()
+{
+  auto result = new cairo_path_t;
+  result->status = CAIRO_STATUS_SUCCESS;
+  result->num_data = 0;
+  result->data = nullptr;
+  return result;
+}
+
+void free_path_copy(cairo_path_t* path)
+{
+  delete[] path->data;
+  delete path;
+}
+
+//Bounds the cubic Bézier p0..p3 in one dimension by its end points and the
+//extrema where its derivative is zero.
+void add_curve_extents(double p0, double p1, double p2, double p3,
+  double& min, double& max)
+{
+  min = std::min(min, std::min(p0, p3));
+  max = std::max(max, std::max(p0, p3));
+
+  //B'(t)/3 = a*t^2 + b*t + c
+  const double a = -p0 + 3 * p1 - 3 * p2 + p3;
+  const double b = 2 * (p0 - 2 * p1 + p2);
+  const double c = p1 - p0;
+
+  double roots[2];
+  int n_roots = 0;
+  if(a == 0)
+  {
+    if(b != 0)
+      roots[n_roots++] = -c / b;
+  }
+  else
+  {
+    const double discriminant = b * b - 4 * a * c;
+    if(discriminant >= 0)
+    {
+      const double root = std::sqrt(discriminant);
+      roots[n_roots++] = (-b + root) / (2 * a);
+      roots[n_roots++] = (-b - root) / (2 * a);
+    }
+  }
+
+  for(int i = 0; i < n_roots; ++i)
+  {
+    const double t = roots[i];
+    if(t <= 0 || t >= 1)
+      continue;
+
+    const double u = 1 - t;
+    const double value =
+      u * u * u * p0 + 3 * u * u * t * p1 + 3 * u * t * t * p2 + t * t * t * p3;
+    min = std::min(min, value);
+    max = std::max(max, value);
+  }
+}
+
+struct Point
+{
+  double x, y;
+};
+
+inline Point midpoint(const Point& a, const Point& b)
+{
+  return { (a.x + b.x) / 2, (a.y + b.y) / 2 };
+}
+
+//The square of the distance from p to the line segment a..b.
+double distance_squared_to_segment(const Point& p, const Point& a, const Point& b)
+{
+  double dx = b.x - a.x;
+  double dy = b.y - a.y;
+  double px = p.x - a.x;
+  double py = p.y - a.y;
+
+  const double length_squared = dx * dx + dy * dy;
+  if(length_squared > 0)
+  {
+    double t = (px * dx + py * dy) / length_squared;
+    t = std::max(0.0, std::min(1.0, t));
+    px -= t * dx;
+    py -= t * dy;
+  }
+
+  return px * px + py * py;
+}
+
+//Calls line_to(point) for the end point of each line that approximates the
+//cubic Bézier p0..p3 within the tolerance, by recursive de Casteljau
+//subdivision, as cairo does.
+template <typename LineTo>
+void flatten_curve(const Point& p0, const Point& p1, const Point& p2, const Point& p3,
+  double tolerance_squared, int depth, const LineTo& line_to)
+{
+  //Limits the recursion for degenerate input such as huge coordinates.
+  const int max_depth = 16;
+
+  if(depth >= max_depth ||
+    (distance_squared_to_segment(p1, p0, p3) <= tolerance_squared &&
+     distance_squared_to_segment(p2, p0, p3) <= tolerance_squared))
+  {
+    line_to(p3);
+    return;
+  }
+
+  const auto ab = midpoint(p0, p1);
+  const auto bc = midpoint(p1, p2);
+  const auto cd = midpoint(p2, p3);
+  const auto abbc = midpoint(ab, bc);
+  const auto bccd = midpoint(bc, cd);
+  const auto mid = midpoint(abbc, bccd);
+
+  flatten_curve(p0, ab, abbc, mid, tolerance_squared, depth + 1, line_to);
+  flatten_curve(mid, bccd, cd, p3, tolerance_squared, depth + 1, line_to);
+}
+
+} //anonymous namespace
+
 Path::Path()
-: m_cobject(nullptr)
+: m_cobject(create_empty_path()),
+  m_owned_by_cairo(false)
 {
-  m_cobject = cairo_path_create();
 }
-*/
 
 Path::Path(cairo_path_t* cobject, bool take_ownership)
-: m_cobject(nullptr)
+: m_cobject(nullptr),
+  m_owned_by_cairo(take_ownership)
 {
   if(take_ownership)
     m_cobject = cobject;
   else
-  {
-    std::cerr << "cairomm: Path::Path(): copying of the underlying cairo_path_t* is not yet implemented." << std::endl;
-    //m_cobject = cairo_path_copy(cobject);
-  }
+    m_cobject = copy_path(cobject);
 }
 
-/*
 Path::Path(const Path& src)
+: m_cobject(src.m_cobject ? copy_path(src.m_cobject) : nullptr),
+  m_owned_by_cairo(false)
 {
-  //Reference-counting, instead of copying by value:
-  if(!src.m_cobject)
-    m_cobject = nullptr;
-  else
-    m_cobject = cairo_path_copy(src.m_cobject);
 }
-*/
+
+Path::Path(Path&& src) noexcept
+: m_cobject(src.m_cobject),
+  m_owned_by_cairo(src.m_owned_by_cairo)
+{
+  src.m_cobject = nullptr;
+}
 
 Path::~Path()
 {
-  if(m_cobject)
+  destroy();
+}
+
+void Path::destroy()
+{
+  if(!m_cobject)
+    return;
+
+  if(m_owned_by_cairo)
     cairo_path_destroy(m_cobject);
+  else
+    free_path_copy(m_cobject);
+
+  m_cobject = nullptr;
 }
 
-/*
 Path& Path::operator=(const Path& src)
 {
-  //Reference-counting, instead of copying by value:
-
   if(this == &src)
     return *this;
 
-  if(m_cobject == src.m_cobject)
+  Path copy(src);
+  swap(copy);
+  return *this;
+}
+
+Path& Path::operator=(Path&& src) noexcept
+{
+  if(this == &src)
     return *this;
 
+  destroy();
+  m_cobject = src.m_cobject;
+  m_owned_by_cairo = src.m_owned_by_cairo;
+  src.m_cobject = nullptr;
+  return *this;
+}
+
+void Path::swap(Path& other) noexcept
+{
+  std::swap(m_cobject, other.m_cobject);
+  std::swap(m_owned_by_cairo, other.m_owned_by_cairo);
+}
+
+Path::const_iterator Path::begin() const
+{
+  return const_iterator(m_cobject ? m_cobject->data : nullptr);
+}
+
+Path::const_iterator Path::end() const
+{
+  return const_iterator(m_cobject ? m_cobject->data + m_cobject->num_data : nullptr);
+}
+
+PathBuilder::PathBuilder()
+: m_last_is_move_to(false),
+  m_has_current_point(false),
+  m_current_x(0), m_current_y(0),
+  m_sub_path_x(0), m_sub_path_y(0)
+{
+}
+
+void PathBuilder::reserve(std::size_t n_data)
+{
+  m_data.reserve(n_data);
+}
+
+void PathBuilder::clear()
+{
+  m_data.clear();
+  m_last_is_move_to = false;
+  m_has_current_point = false;
+  m_current_x = m_current_y = 0;
+  m_sub_path_x = m_sub_path_y = 0;
+}
+
+void PathBuilder::add_header(cairo_path_data_type_t type, int length)
+{
+  m_last_is_move_to = false;
+  cairo_path_data_t data;
+  data.header.type = type;
+  data.header.length = length;
+  m_data.push_back(data);
+}
+
+void PathBuilder::add_point(double x, double y)
+{
+  cairo_path_data_t data;
+  data.point.x = x;
+  data.point.y = y;
+  m_data.push_back(data);
+}
+
+void PathBuilder::move_to(double x, double y)
+{
+  //Like cairo, consecutive move_to()s collapse into the last one:
+  if(m_last_is_move_to)
+    m_data.resize(m_data.size() - 2);
+
+  add_header(CAIRO_PATH_MOVE_TO, 2);
+  add_point(x, y);
+  m_last_is_move_to = true;
+  m_has_current_point = true;
+  m_current_x = m_sub_path_x = x;
+  m_current_y = m_sub_path_y = y;
+}
+
+void PathBuilder::line_to(double x, double y)
+{
+  if(!m_has_current_point)
+  {
+    move_to(x, y);
+    return;
+  }
+
+  add_header(CAIRO_PATH_LINE_TO, 2);
+  add_point(x, y);
+  m_current_x = x;
+  m_current_y = y;
+}
+
+void PathBuilder::curve_to(double x1, double y1, double x2, double y2, double x3, double y3)
+{
+  if(!m_has_current_point)
+    move_to(x1, y1);
+
+  add_header(CAIRO_PATH_CURVE_TO, 4);
+  add_point(x1, y1);
+  add_point(x2, y2);
+  add_point(x3, y3);
+  m_current_x = x3;
+  m_current_y = y3;
+}
+
+void PathBuilder::rel_move_to(double dx, double dy)
+{
+  if(!m_has_current_point)
+    throw_exception(CAIRO_STATUS_NO_CURRENT_POINT);
+
+  move_to(m_current_x + dx, m_current_y + dy);
+}
+
+void PathBuilder::rel_line_to(double dx, double dy)
+{
+  if(!m_has_current_point)
+    throw_exception(CAIRO_STATUS_NO_CURRENT_POINT);
+
+  line_to(m_current_x + dx, m_current_y + dy);
+}
+
+void PathBuilder::rel_curve_to(double dx1, double dy1, double dx2, double dy2, double dx3, double dy3)
+{
+  if(!m_has_current_point)
+    throw_exception(CAIRO_STATUS_NO_CURRENT_POINT);
+
+  const auto x = m_current_x;
+  const auto y = m_current_y;
+  curve_to(x + dx1, y + dy1, x + dx2, y + dy2, x + dx3, y + dy3);
+}
+
+void PathBuilder::rectangle(double x, double y, double width, double height)
+{
+  move_to(x, y);
+  line_to(x + width, y);
+  line_to(x + width, y + height);
+  line_to(x, y + height);
+  close_path();
+}
+
+void PathBuilder::close_path()
+{
+  if(!m_has_current_point)
+    return;
+
+  add_header(CAIRO_PATH_CLOSE_PATH, 1);
+  move_to(m_sub_path_x, m_sub_path_y);
+}
+
+void PathBuilder::append_path(const Path& path)
+{
+  for(const auto& segment : path)
+  {
+    double x1, y1, x2, y2, x3, y3;
+    switch(segment.get_type())
+    {
+    case PATH_MOVE_TO:
+      segment.get_point(0, x1, y1);
+      move_to(x1, y1);
+      break;
+    case PATH_LINE_TO:
+      segment.get_point(0, x1, y1);
+      line_to(x1, y1);
+      break;
+    case PATH_CURVE_TO:
+      segment.get_point(0, x1, y1);
+      segment.get_point(1, x2, y2);
+      segment.get_point(2, x3, y3);
+      curve_to(x1, y1, x2, y2, x3, y3);
+      break;
+    case PATH_CLOSE_PATH:
+      close_path();
+      break;
+    }
+  }
+}
+
+void PathBuilder::get_current_point(double& x, double& y) const
+{
+  x = m_current_x;
+  y = m_current_y;
+}
+
+cairo_path_t PathBuilder::get_cpath() const
+{
+  cairo_path_t result;
+  result.status = CAIRO_STATUS_SUCCESS;
+  result.data = const_cast<cairo_path_data_t*>(m_data.data());
+  result.num_data = static_cast<int>(m_data.size());
+  return result;
+}
+
+Path PathBuilder::get_path() const
+{
+  auto cpath = get_cpath();
+  return Path(&cpath, false /* copy */);
+}
+
+void Path::transform(const Matrix& matrix)
+{
+  if(!m_cobject)
+    return;
+
+  const double xx = matrix.xx, yx = matrix.yx;
+  const double xy = matrix.xy, yy = matrix.yy;
+  const double x0 = matrix.x0, y0 = matrix.y0;
+
+  auto data = m_cobject->data;
+  const auto end = data + m_cobject->num_data;
+  while(data != end)
+  {
+    const auto length = data->header.length;
+
+    //The points of a segment follow its header.
+    auto point = data + 1;
+    const auto last = data + length;
+    for(; point != last; ++point)
+    {
+      const double x = point->point.x;
+      const double y = point->point.y;
+      point->point.x = xx * x + xy * y + x0;
+      point->point.y = yx * x + yy * y + y0;
+    }
+
+    data += length;
+  }
+}
+
+void Path::get_extents(double& x1, double& y1, double& x2, double& y2) const
+{
+  double min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+  bool has_extents = false;
+  double current_x = 0, current_y = 0;
+
+  auto add_point = [&](double x, double y)
+  {
+    if(!has_extents)
+    {
+      min_x = max_x = x;
+      min_y = max_y = y;
+      has_extents = true;
+      return;
+    }
+
+    min_x = std::min(min_x, x);
+    max_x = std::max(max_x, x);
+    min_y = std::min(min_y, y);
+    max_y = std::max(max_y, y);
+  };
+
+  for(const auto& segment : *this)
+  {
+    double x, y;
+    switch(segment.get_type())
+    {
+    case PATH_MOVE_TO:
+      segment.get_point(0, current_x, current_y);
+      break;
+    case PATH_LINE_TO:
+      segment.get_point(0, x, y);
+      add_point(current_x, current_y);
+      add_point(x, y);
+      current_x = x;
+      current_y = y;
+      break;
+    case PATH_CURVE_TO:
+    {
+      double cx1, cy1, cx2, cy2;
+      segment.get_point(0, cx1, cy1);
+      segment.get_point(1, cx2, cy2);
+      segment.get_point(2, x, y);
+      add_point(current_x, current_y);
+      add_curve_extents(current_x, cx1, cx2, x, min_x, max_x);
+      add_curve_extents(current_y, cy1, cy2, y, min_y, max_y);
+      current_x = x;
+      current_y = y;
+      break;
+    }
+    case PATH_CLOSE_PATH:
+      //The closing line ends at a point that is already included.
+      break;
+    }
+  }
+
+  x1 = min_x;
+  y1 = min_y;
+  x2 = max_x;
+  y2 = max_y;
+}
+
+Path Path::flatten(double tolerance) const
+{
+  PathBuilder builder;
   if(m_cobject)
+    builder.reserve(m_cobject->num_data);
+
+  const double tolerance_squared = tolerance * tolerance;
+  Point current = { 0, 0 };
+  auto line_to = [&builder](const Point& point)
   {
-    cairo_path_destroy(m_cobject);
-    m_cobject = nullptr;
+    builder.line_to(point.x, point.y);
+  };
+
+  for(const auto& segment : *this)
+  {
+    switch(segment.get_type())
+    {
+    case PATH_MOVE_TO:
+      segment.get_point(0, current.x, current.y);
+      builder.move_to(current.x, current.y);
+      break;
+    case PATH_LINE_TO:
+      segment.get_point(0, current.x, current.y);
+      builder.line_to(current.x, current.y);
+      break;
+    case PATH_CURVE_TO:
+    {
+      Point p1, p2, p3;
+      segment.get_point(0, p1.x, p1.y);
+      segment.get_point(1, p2.x, p2.y);
+      segment.get_point(2, p3.x, p3.y);
+      flatten_curve(current, p1, p2, p3, tolerance_squared, 0, line_to);
+      current = p3;
+      break;
+    }
+    case PATH_CLOSE_PATH:
+      builder.close_path();
+      builder.get_current_point(current.x, current.y);
+      break;
+    }
   }
 
-  if(!src.m_cobject)
-    return *this;
+  return builder.get_path();
+}
 
-  m_cobject = cairo_path_copy(src.m_cobject);
+double Path::get_length(double tolerance) const
+{
+  double length = 0;
+  const double tolerance_squared = tolerance * tolerance;
+  Point current = { 0, 0 };
+  Point sub_path_start = { 0, 0 };
+  auto line_to = [&length, &current](const Point& point)
+  {
+    length += std::hypot(point.x - current.x, point.y - current.y);
+    current = point;
+  };
 
-  return *this;
+  for(const auto& segment : *this)
+  {
+    switch(segment.get_type())
+    {
+    case PATH_MOVE_TO:
+      segment.get_point(0, current.x, current.y);
+      sub_path_start = current;
+      break;
+    case PATH_LINE_TO:
+    {
+      Point point;
+      segment.get_point(0, point.x, point.y);
+      line_to(point);
+      break;
+    }
+    case PATH_CURVE_TO:
+    {
+      Point p1, p2, p3;
+      segment.get_point(0, p1.x, p1.y);
+      segment.get_point(1, p2.x, p2.y);
+      segment.get_point(2, p3.x, p3.y);
+      const auto p0 = current; //line_to() changes current.
+      flatten_curve(p0, p1, p2, p3, tolerance_squared, 0, line_to);
+      break;
+    }
+    case PATH_CLOSE_PATH:
+      line_to(sub_path_start);
+      break;
+    }
+  }
+
+  return length;
 }
-*/
 
 /*
 bool Path::operator==(const Path& src) const
@@ -20,7 +20,11 @@
 #define __CAIROMM_PATH_H
 
 #include <cairomm/enums.h>
+#include <cairomm/matrix.h>
+#include <cstddef>
+#include <iterator>
 #include <string>
+#include <vector>
 #include <cairo.h>
 
 
@@ -32,21 +36,176 @@ namespace Cairo
  * Path.  The application is responsible for freeing the Path object when it is
  * no longer needed.
  *
- * @todo There's currently no way to access the path data without reverting to
- * the C object (see cobj())
+ * A Path is a value type: copying it copies the path data, and moving it
+ * transfers the data without copying. This makes it cheap to keep pre-built
+ * paths around and replay them with Context::append_path().
+ *
+ * The path data can be walked with begin() and end() without copying it:
+ *
+ * @code
+ * for(const auto& segment : path)
+ * {
+ *   if(segment.get_type() == Cairo::PATH_LINE_TO)
+ *   {
+ *     double x, y;
+ *     segment.get_point(0, x, y);
+ *   }
+ * }
+ * @endcode
  */
 class Path
 {
 public:
-  //Path();
+  /** One element of a path: an operation and the points it uses.
+   * It refers directly to the data of the Path, so it is only valid as long
+   * as the Path is not modified or destroyed.
+   */
+  class Segment
+  {
+  public:
+    explicit Segment(const cairo_path_data_t* data)
+    : m_data(data)
+    {}
+
+    /** Gets the operation of this segment. */
+    inline PathDataType get_type() const
+    { return static_cast<PathDataType>(m_data->header.type); }
+
+    /** Gets the number of points used by this segment: 1 for PATH_MOVE_TO
+     * and PATH_LINE_TO, 3 for PATH_CURVE_TO and 0 for PATH_CLOSE_PATH.
+     */
+    inline int get_num_points() const
+    { return m_data->header.length - 1; }
+
+    /** Gets one of the points of this segment.
+     *
+     * @param index	the index of the point, less than get_num_points().
+     * @param x	return value for the X coordinate of the point
+     * @param y	return value for the Y coordinate of the point
+     */
+    inline void get_point(int index, double& x, double& y) const
+    {
+      x = m_data[index + 1].point.x;
+      y = m_data[index + 1].point.y;
+    }
+
+    /** The header element of this segment, followed by its points. */
+    inline const cairo_path_data_t* cobj() const { return m_data; }
+
+  private:
+    const cairo_path_data_t* m_data;
+  };
+
+  /** A forward iterator over the segments of a Path. */
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Segment value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Segment* pointer;
+    typedef const Segment& reference;
+
+    explicit const_iterator(const cairo_path_data_t* data = nullptr)
+    : m_segment(data)
+    {}
+
+    inline reference operator*() const { return m_segment; }
+    inline pointer operator->() const { return &m_segment; }
+
+    inline const_iterator& operator++()
+    {
+      m_segment = Segment(m_segment.cobj() + m_segment.cobj()->header.length);
+      return *this;
+    }
+
+    inline const_iterator operator++(int)
+    {
+      const_iterator result(*this);
+      ++(*this);
+      return result;
+    }
+
+    inline bool operator==(const const_iterator& other) const
+    { return m_segment.cobj() == other.m_segment.cobj(); }
+
+    inline bool operator!=(const const_iterator& other) const
+    { return !(*this == other); }
+
+  private:
+    Segment m_segment;
+  };
+
+  /** Creates an empty path. */
+  Path();
+
+  /** Wraps or copies a C path.
+   *
+   * @param cobject	the C path
+   * @param take_ownership	if true, the Path takes ownership of @a cobject
+   * and will destroy it. Otherwise @a cobject is copied and the caller keeps
+   * ownership of it.
+   */
   explicit Path(cairo_path_t* cobject, bool take_ownership = false);
 
-  Path(const Path&) = delete;
-  Path& operator=(const Path&) = delete;
+  /** Copies the path data of @a src. */
+  Path(const Path& src);
+
+  /** Takes the path data of @a src without copying it.
+   * @a src may only be assigned to or destroyed afterwards.
+   */
+  Path(Path&& src) noexcept;
+
+  Path& operator=(const Path& src);
+  Path& operator=(Path&& src) noexcept;
 
   virtual ~Path();
 
-  //Path& operator=(const Path& src);
+  void swap(Path& other) noexcept;
+
+  /** Gets an iterator to the first segment of the path. */
+  const_iterator begin() const;
+
+  /** Gets an iterator past the last segment of the path. */
+  const_iterator end() const;
+
+  /** Transforms every point of the path by @a matrix, in place.
+   *
+   * This gives the same points as appending the path to a Context whose
+   * transformation is @a matrix and copying it back in device space.
+   *
+   * @param matrix	the transformation to apply
+   */
+  void transform(const Matrix& matrix);
+
+  /** Computes a bounding box covering the points on the path, without a
+   * Context. Curves are bounded tightly, not by their control points.
+   *
+   * This follows the rules of Context::get_path_extents(): a lone move_to()
+   * does not contribute, and an empty path gives ((0,0), (0,0)).
+   *
+   * @param x1 left of the resulting extents
+   * @param y1 top of the resulting extents
+   * @param x2 right of the resulting extents
+   * @param y2 bottom of the resulting extents
+   */
+  void get_extents(double& x1, double& y1, double& x2, double& y2) const;
+
+  /** Creates a copy of the path with every curve replaced by line segments,
+   * in the same way as Context::copy_path_flat() but without a Context.
+   *
+   * @param tolerance	the maximum distance between a curve and its
+   * approximation. See Context::set_tolerance().
+   */
+  Path flatten(double tolerance = 0.1) const;
+
+  /** Computes the length of the path, including the lines added by
+   * close_path(). Curves are measured by flattening them with @a tolerance.
+   *
+   * @param tolerance	the maximum distance between a curve and the lines
+   * that are measured in its place.
+   */
+  double get_length(double tolerance = 0.1) const;
 
   //bool operator ==(const Path& src) const;
   //bool operator !=(const Path& src) const;
@@ -63,8 +222,125 @@ public:
   #endif //DOXYGEN_IGNORE_THIS
 
 protected:
+  void destroy();
 
   cobject* m_cobject;
+
+  //Whether m_cobject was allocated by cairo (and must be freed with
+  //cairo_path_destroy()), or copied by cairomm.
+  bool m_owned_by_cairo;
+};
+
+/** Builds a Path without a Context.
+ *
+ * Segments are appended to one contiguous, growable buffer of
+ * cairo_path_data_t, in the same layout that Context::copy_path() produces.
+ * No surface or Context is needed, so paths can be built on any thread and
+ * later given to Context::append_path().
+ *
+ * The buffer is kept by clear(), so a PathBuilder can be reused to build many
+ * paths without reallocating.
+ *
+ * @code
+ * Cairo::PathBuilder builder;
+ * builder.move_to(0, 0);
+ * builder.line_to(10, 0);
+ * builder.line_to(10, 10);
+ * builder.close_path();
+ * auto path = builder.get_path();
+ * context->append_path(path);
+ * @endcode
+ */
+class PathBuilder
+{
+public:
+  PathBuilder();
+
+  /** Makes sure that at least @a n_data elements can be added without
+   * reallocating. A line_to() uses 2 elements and a curve_to() uses 4.
+   */
+  void reserve(std::size_t n_data);
+
+  /** Removes all segments but keeps the allocated buffer. */
+  void clear();
+
+  /** Gets the number of cairo_path_data_t elements in the path. */
+  inline std::size_t size() const { return m_data.size(); }
+
+  /** Gets the number of elements that fit in the buffer without reallocating. */
+  inline std::size_t capacity() const { return m_data.capacity(); }
+
+  /** Begins a new sub-path. See Context::move_to(). */
+  void move_to(double x, double y);
+
+  /** Adds a line to the path. If there is no current point this behaves as
+   * move_to(). See Context::line_to().
+   */
+  void line_to(double x, double y);
+
+  /** Adds a cubic Bézier spline to the path. If there is no current point
+   * this behaves as if preceded by move_to(x1, y1). See Context::curve_to().
+   */
+  void curve_to(double x1, double y1, double x2, double y2, double x3, double y3);
+
+  /** Relative-coordinate version of move_to().
+   *
+   * @exception Cairo::logic_error if there is no current point.
+   */
+  void rel_move_to(double dx, double dy);
+
+  /** Relative-coordinate version of line_to().
+   *
+   * @exception Cairo::logic_error if there is no current point.
+   */
+  void rel_line_to(double dx, double dy);
+
+  /** Relative-coordinate version of curve_to().
+   *
+   * @exception Cairo::logic_error if there is no current point.
+   */
+  void rel_curve_to(double dx1, double dy1, double dx2, double dy2, double dx3, double dy3);
+
+  /** Adds a closed sub-path rectangle. See Context::rectangle(). */
+  void rectangle(double x, double y, double width, double height);
+
+  /** Closes the current sub-path. Like cairo, this adds a move_to() to the
+   * start of the sub-path after the close. If there is no current point,
+   * this has no effect. See Context::close_path().
+   */
+  void close_path();
+
+  /** Appends all segments of @a path. */
+  void append_path(const Path& path);
+
+  /** Checks whether there is a current point. */
+  inline bool has_current_point() const { return m_has_current_point; }
+
+  /** Gets the current point. The result is (0, 0) if there is no current
+   * point.
+   */
+  void get_current_point(double& x, double& y) const;
+
+  /** Creates a Path from the segments added so far. The PathBuilder is not
+   * changed, so it can still be added to or cleared.
+   */
+  Path get_path() const;
+
+  /** Gets the segments as a C path. The returned path refers to the buffer
+   * of this PathBuilder, so it is only valid until the PathBuilder is
+   * modified or destroyed. It must not be destroyed with cairo_path_destroy().
+   */
+  cairo_path_t get_cpath() const;
+
+private:
+  void add_header(cairo_path_data_type_t type, int length);
+  void add_point(double x, double y);
+
+  std::vector<cairo_path_data_t> m_data;
+  bool m_last_is_move_to;
+  bool m_has_current_point;
+  double m_current_x, m_current_y;
+  double m_sub_path_x, m_sub_path_y;
 };
 
 } // namespace Cairo
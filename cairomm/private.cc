@@ -19,8 +19,12 @@
 #include <cairommconfig.h> //For CAIROMM_EXCEPTIONS_ENABLED
 #include <cairomm/private.h>
 #include <cairomm/exception.h>
+#include <cairomm/surface.h>
+#include <cairomm/pattern.h>
+#include <cstdint>
 #include <stdexcept>
 #include <iostream>
+#include <mutex>
 
 namespace Cairo
 {
@@ -80,6 +84,137 @@ void throw_exception(ErrorStatus /* status */)
 }
 #endif //CAIROMM_EXCEPTIONS_ENABLED
 
+static cairo_user_data_key_t USER_DATA_KEY_SURFACE_WRAPPER = {0};
+static cairo_user_data_key_t USER_DATA_KEY_PATTERN_WRAPPER = {0};
+
+// Getters such as Context::get_target() may be called from several threads on
+// the same surface or pattern, so the cached wrapper is only read and written
+// with a lock. The locks are striped by C instance, so that threads using
+// different objects rarely wait for each other.
+static std::mutex wrapper_mutexes[16];
+
+static std::mutex& get_wrapper_mutex(const void* cobject)
+{
+  return wrapper_mutexes[(reinterpret_cast<std::uintptr_t>(cobject) >> 4) % 16];
+}
+
+#ifndef CAIROMM_INTRUSIVE_REFPTR
+template <class T_CppObject>
+static void
+free_weak_wrapper(void* data)
+{
+  delete static_cast<std::weak_ptr<T_CppObject>*>(data);
+}
+
+RefPtr<Surface> get_cached_wrapper(cairo_surface_t* cobject)
+{
+  std::lock_guard<std::mutex> lock(get_wrapper_mutex(cobject));
+  auto weak = static_cast<std::weak_ptr<Surface>*>(
+    cairo_surface_get_user_data(cobject, &USER_DATA_KEY_SURFACE_WRAPPER));
+  return weak ? weak->lock() : RefPtr<Surface>();
+}
+
+RefPtr<Pattern> get_cached_wrapper(cairo_pattern_t* cobject)
+{
+  std::lock_guard<std::mutex> lock(get_wrapper_mutex(cobject));
+  auto weak = static_cast<std::weak_ptr<Pattern>*>(
+    cairo_pattern_get_user_data(cobject, &USER_DATA_KEY_PATTERN_WRAPPER));
+  return weak ? weak->lock() : RefPtr<Pattern>();
+}
+
+void cache_wrapper(const RefPtr<Surface>& wrapper)
+{
+  auto cobject = const_cast<cairo_surface_t*>(wrapper->cobj());
+  std::lock_guard<std::mutex> lock(get_wrapper_mutex(cobject));
+  auto weak = static_cast<std::weak_ptr<Surface>*>(
+    cairo_surface_get_user_data(cobject, &USER_DATA_KEY_SURFACE_WRAPPER));
+
+  // Reuse the slot of an expired wrapper, so that re-wrapping does not allocate.
+  if(weak)
+  {
+    *weak = wrapper;
+    return;
+  }
+
+  // The slot is freed by free_weak_wrapper() when the C instance is destroyed.
+  // It does not keep the wrapper alive, so there is no reference cycle.
+  weak = new std::weak_ptr<Surface>(wrapper);
+  if(cairo_surface_set_user_data(cobject, &USER_DATA_KEY_SURFACE_WRAPPER,
+                                 weak, &free_weak_wrapper<Surface>) != CAIRO_STATUS_SUCCESS)
+    delete weak;
+}
+
+void cache_wrapper(const RefPtr<Pattern>& wrapper)
+{
+  auto cobject = const_cast<cairo_pattern_t*>(wrapper->cobj());
+  std::lock_guard<std::mutex> lock(get_wrapper_mutex(cobject));
+  auto weak = static_cast<std::weak_ptr<Pattern>*>(
+    cairo_pattern_get_user_data(cobject, &USER_DATA_KEY_PATTERN_WRAPPER));
+
+  if(weak)
+  {
+    *weak = wrapper;
+    return;
+  }
+
+  weak = new std::weak_ptr<Pattern>(wrapper);
+  if(cairo_pattern_set_user_data(cobject, &USER_DATA_KEY_PATTERN_WRAPPER,
+                                 weak, &free_weak_wrapper<Pattern>) != CAIRO_STATUS_SUCCESS)
+    delete weak;
+}
+
+#else //CAIROMM_INTRUSIVE_REFPTR
+
+// With the intrusive RefPtr, a wrapper is never deleted by RefPtr, so it stays
+// valid for as long as its C instance exists. The user data can then simply
+// point to it, and the wrapper is reused even when no RefPtr holds it.
+
+RefPtr<Surface> get_cached_wrapper(cairo_surface_t* cobject)
+{
+  Surface* wrapper = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(get_wrapper_mutex(cobject));
+    wrapper = static_cast<Surface*>(
+      cairo_surface_get_user_data(cobject, &USER_DATA_KEY_SURFACE_WRAPPER));
+  }
+  if(!wrapper)
+    return RefPtr<Surface>();
+
+  wrapper->reference();
+  return make_refptr_for_instance<Surface>(wrapper);
+}
+
+RefPtr<Pattern> get_cached_wrapper(cairo_pattern_t* cobject)
+{
+  Pattern* wrapper = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(get_wrapper_mutex(cobject));
+    wrapper = static_cast<Pattern*>(
+      cairo_pattern_get_user_data(cobject, &USER_DATA_KEY_PATTERN_WRAPPER));
+  }
+  if(!wrapper)
+    return RefPtr<Pattern>();
+
+  wrapper->reference();
+  return make_refptr_for_instance<Pattern>(wrapper);
+}
+
+void cache_wrapper(const RefPtr<Surface>& wrapper)
+{
+  auto cobject = const_cast<cairo_surface_t*>(wrapper->cobj());
+  std::lock_guard<std::mutex> lock(get_wrapper_mutex(cobject));
+  cairo_surface_set_user_data(cobject, &USER_DATA_KEY_SURFACE_WRAPPER, wrapper.get(), nullptr);
+}
+
+void cache_wrapper(const RefPtr<Pattern>& wrapper)
+{
+  auto cobject = const_cast<cairo_pattern_t*>(wrapper->cobj());
+  std::lock_guard<std::mutex> lock(get_wrapper_mutex(cobject));
+  cairo_pattern_set_user_data(cobject, &USER_DATA_KEY_PATTERN_WRAPPER, wrapper.get(), nullptr);
+}
+
+#endif //CAIROMM_INTRUSIVE_REFPTR
+
 } //namespace Cairo
 
 // vim: ts=2 sw=2 et
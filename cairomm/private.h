@@ -21,6 +21,7 @@
 
 #include <cairomm/enums.h>
 #include <cairomm/exception.h>
+#include <cairomm/refptr.h>
 #include <string>
 
 #ifndef DOXYGEN_IGNORE_THIS
@@ -44,6 +45,29 @@ void check_object_status_and_throw_exception(const T& object)
   check_status_and_throw_exception(object.get_status());
 }
 
+class Surface;
+class Pattern;
+
+// The C++ wrapper of a C instance is remembered in the C instance's user data,
+// as a weak reference, so that getters such as Context::get_target() can hand
+// out the same RefPtr again instead of allocating a new wrapper every time.
+
+/// Returns the wrapper still alive for @a cobject, or an empty RefPtr.
+RefPtr<Surface> get_cached_wrapper(cairo_surface_t* cobject);
+RefPtr<Pattern> get_cached_wrapper(cairo_pattern_t* cobject);
+
+/// Makes @a wrapper the one returned by get_cached_wrapper() for its C instance.
+void cache_wrapper(const RefPtr<Surface>& wrapper);
+void cache_wrapper(const RefPtr<Pattern>& wrapper);
+
+template <class T_CppObject>
+RefPtr<T_CppObject> make_cached_refptr_for_instance(T_CppObject* object)
+{
+  auto result = make_refptr_for_instance<T_CppObject>(object);
+  cache_wrapper(result);
+  return result;
+}
+
 } // namespace Cairo
 #endif //DOXYGEN_IGNORE_THIS
 
@@ -24,6 +24,9 @@
  * 02110-1301, USA.
  */
 
+#include <cairommconfig.h> //For CAIROMM_INTRUSIVE_REFPTR
+#include <cstddef>
+#include <type_traits>
 #include <utility>
 
 namespace Cairo
@@ -38,6 +41,8 @@ void RefPtrDeleter(T_CppObject* object)
   object->unreference();
 }
 
+#ifndef CAIROMM_INTRUSIVE_REFPTR
+
 /** RefPtr<> is a reference-counting shared smartpointer.
  *
  * Reference counting means that a shared reference count is incremented each
@@ -49,6 +54,10 @@ void RefPtrDeleter(T_CppObject* object)
  * to delete the object explicitly, or know when a method expects you to delete 
  * the object that it returns, and to prevent any need to manually  reference 
  * and unreference() cairo objects.
+ *
+ * When cairomm is configured with the intrusive RefPtr option, RefPtr is
+ * instead a small class that uses the reference count of the underlying
+ * cairo object. See make_refptr_for_instance().
  */
 template <class T_CppObject>
 using RefPtr = std::shared_ptr<T_CppObject>;
@@ -60,6 +69,221 @@ make_refptr_for_instance(T_CppObject* object)
   return RefPtr<T_CppObject>(object, &RefPtrDeleter<T_CppObject>);
 }
 
+// So that code calling Cairo::dynamic_pointer_cast() etc. builds with both
+// kinds of RefPtr.
+using std::dynamic_pointer_cast;
+using std::static_pointer_cast;
+using std::const_pointer_cast;
+
+#else //CAIROMM_INTRUSIVE_REFPTR
+
+/** RefPtr<> is a reference-counting shared smartpointer.
+ *
+ * This is the intrusive RefPtr, used when cairomm is configured with the
+ * intrusive RefPtr option. It has no reference count of its own: copying a
+ * RefPtr calls the object's reference(), and destroying it calls the object's
+ * unreference(), which map directly to the cairo_*_reference() and
+ * cairo_*_destroy() functions of the underlying cairo object. Compared to the
+ * std::shared_ptr based RefPtr, this saves one heap allocation per wrapped
+ * object and one atomic operation per copy.
+ *
+ * It provides the subset of the std::shared_ptr API that is meaningful for
+ * cairo objects. Use Cairo::dynamic_pointer_cast(),
+ * Cairo::static_pointer_cast() and Cairo::const_pointer_cast() instead of the
+ * std:: versions.
+ */
+template <class T_CppObject>
+class RefPtr
+{
+public:
+  typedef T_CppObject element_type;
+
+  /** Default constructor
+   *
+   * Afterwards it will be null and use of -> will cause a segmentation fault.
+   */
+  RefPtr() noexcept
+  : pCppObject_(nullptr)
+  {}
+
+  RefPtr(std::nullptr_t) noexcept
+  : pCppObject_(nullptr)
+  {}
+
+  /** Takes over the reference that @a pCppObject already holds, without
+   * taking another one. Use make_refptr_for_instance() instead.
+   */
+  explicit RefPtr(T_CppObject* pCppObject) noexcept
+  : pCppObject_(pCppObject)
+  {}
+
+  RefPtr(const RefPtr& src) noexcept
+  : pCppObject_(src.pCppObject_)
+  {
+    if(pCppObject_)
+      pCppObject_->reference();
+  }
+
+  RefPtr(RefPtr&& src) noexcept
+  : pCppObject_(src.pCppObject_)
+  {
+    src.pCppObject_ = nullptr;
+  }
+
+  template <class T_CastFrom, class = typename std::enable_if<
+    std::is_convertible<T_CastFrom*, T_CppObject*>::value>::type>
+  RefPtr(const RefPtr<T_CastFrom>& src) noexcept
+  : pCppObject_(src.get())
+  {
+    if(pCppObject_)
+      pCppObject_->reference();
+  }
+
+  template <class T_CastFrom, class = typename std::enable_if<
+    std::is_convertible<T_CastFrom*, T_CppObject*>::value>::type>
+  RefPtr(RefPtr<T_CastFrom>&& src) noexcept
+  : pCppObject_(src.pCppObject_)
+  {
+    src.pCppObject_ = nullptr;
+  }
+
+  ~RefPtr() noexcept
+  {
+    if(pCppObject_)
+      pCppObject_->unreference();
+  }
+
+  RefPtr& operator=(const RefPtr& src) noexcept
+  {
+    RefPtr(src).swap(*this);
+    return *this;
+  }
+
+  RefPtr& operator=(RefPtr&& src) noexcept
+  {
+    RefPtr(std::move(src)).swap(*this);
+    return *this;
+  }
+
+  template <class T_CastFrom>
+  RefPtr& operator=(const RefPtr<T_CastFrom>& src) noexcept
+  {
+    RefPtr(src).swap(*this);
+    return *this;
+  }
+
+  template <class T_CastFrom>
+  RefPtr& operator=(RefPtr<T_CastFrom>&& src) noexcept
+  {
+    RefPtr(std::move(src)).swap(*this);
+    return *this;
+  }
+
+  RefPtr& operator=(std::nullptr_t) noexcept
+  {
+    reset();
+    return *this;
+  }
+
+  void swap(RefPtr& other) noexcept
+  {
+    std::swap(pCppObject_, other.pCppObject_);
+  }
+
+  /// Releases the reference, if any, and sets this RefPtr to null.
+  void reset() noexcept
+  {
+    RefPtr().swap(*this);
+  }
+
+  inline T_CppObject* get() const noexcept
+  { return pCppObject_; }
+
+  inline T_CppObject* operator->() const noexcept
+  { return pCppObject_; }
+
+  inline T_CppObject& operator*() const noexcept
+  { return *pCppObject_; }
+
+  /// Test whether the RefPtr<> points to any underlying instance.
+  inline explicit operator bool() const noexcept
+  { return pCppObject_ != nullptr; }
+
+private:
+  template <class T_CastFrom>
+  friend class RefPtr;
+
+  T_CppObject* pCppObject_;
+};
+
+template <class T_CppObject>
+RefPtr<T_CppObject>
+make_refptr_for_instance(T_CppObject* object)
+{
+  return RefPtr<T_CppObject>(object);
+}
+
+template <class T_CppObject, class T_CastFrom>
+RefPtr<T_CppObject> dynamic_pointer_cast(const RefPtr<T_CastFrom>& src) noexcept
+{
+  const auto pCppObject = dynamic_cast<T_CppObject*>(src.get());
+  if(pCppObject)
+    pCppObject->reference();
+  return RefPtr<T_CppObject>(pCppObject);
+}
+
+template <class T_CppObject, class T_CastFrom>
+RefPtr<T_CppObject> static_pointer_cast(const RefPtr<T_CastFrom>& src) noexcept
+{
+  const auto pCppObject = static_cast<T_CppObject*>(src.get());
+  if(pCppObject)
+    pCppObject->reference();
+  return RefPtr<T_CppObject>(pCppObject);
+}
+
+template <class T_CppObject, class T_CastFrom>
+RefPtr<T_CppObject> const_pointer_cast(const RefPtr<T_CastFrom>& src) noexcept
+{
+  const auto pCppObject = const_cast<T_CppObject*>(src.get());
+  if(pCppObject)
+    pCppObject->reference();
+  return RefPtr<T_CppObject>(pCppObject);
+}
+
+template <class T_CppObject, class T_Other>
+inline bool operator==(const RefPtr<T_CppObject>& lhs, const RefPtr<T_Other>& rhs) noexcept
+{ return lhs.get() == rhs.get(); }
+
+template <class T_CppObject, class T_Other>
+inline bool operator!=(const RefPtr<T_CppObject>& lhs, const RefPtr<T_Other>& rhs) noexcept
+{ return lhs.get() != rhs.get(); }
+
+template <class T_CppObject, class T_Other>
+inline bool operator<(const RefPtr<T_CppObject>& lhs, const RefPtr<T_Other>& rhs) noexcept
+{ return lhs.get() < rhs.get(); }
+
+template <class T_CppObject>
+inline bool operator==(const RefPtr<T_CppObject>& lhs, std::nullptr_t) noexcept
+{ return !lhs; }
+
+template <class T_CppObject>
+inline bool operator==(std::nullptr_t, const RefPtr<T_CppObject>& rhs) noexcept
+{ return !rhs; }
+
+template <class T_CppObject>
+inline bool operator!=(const RefPtr<T_CppObject>& lhs, std::nullptr_t) noexcept
+{ return static_cast<bool>(lhs); }
+
+template <class T_CppObject>
+inline bool operator!=(std::nullptr_t, const RefPtr<T_CppObject>& rhs) noexcept
+{ return static_cast<bool>(rhs); }
+
+template <class T_CppObject>
+inline void swap(RefPtr<T_CppObject>& lhs, RefPtr<T_CppObject>& rhs) noexcept
+{ lhs.swap(rhs); }
+
+#endif //CAIROMM_INTRUSIVE_REFPTR
+
 } // namespace Cairo
 
 #endif /* _cairo_REFPTR_H */
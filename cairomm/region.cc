@@ -18,11 +18,30 @@
 
 #include <cairomm/region.h>
 #include <cairomm/private.h>
-#include <algorithm>
 
 namespace Cairo
 {
 
+namespace
+{
+
+typedef cairo_status_t (*RegionOperation)(cairo_region_t*, const cairo_region_t*);
+
+//cairo_region_create_rectangles() sorts the rectangles into bands once, so
+//that the operation merges the two regions only once.
+void apply_to_rectangles(cairo_region_t* region, RegionOperation operation,
+  const RectangleInt* rects, int count)
+{
+  auto other = cairo_region_create_rectangles(rects, count);
+  auto status = cairo_region_status(other);
+  if(status == CAIRO_STATUS_SUCCESS)
+    status = operation(region, other);
+  cairo_region_destroy(other);
+  check_status_and_throw_exception(status);
+}
+
+} //anonymous namespace
+
 Region::Region()
 : m_cobject(cairo_region_create())
 {
@@ -35,16 +54,9 @@ Region::Region(const RectangleInt& rectangle)
   check_object_status_and_throw_exception (*this);
 }
 
-// less efficient but convenient
 Region::Region(const std::vector<RectangleInt>& rects) :
-  m_cobject(nullptr)
+  m_cobject(cairo_region_create_rectangles (rects.data(), rects.size()))
 {
-  auto *carray = new RectangleInt[rects.size()];
-  std::copy(rects.begin(), rects.end(), carray);
-  m_cobject = cairo_region_create_rectangles (carray, rects.size());
-
-  delete[] carray;
-
   check_object_status_and_throw_exception (*this);
 }
 
@@ -126,6 +138,21 @@ RectangleInt Region::get_rectangle(int nth_rectangle) const
   return result;
 }
 
+void Region::get_rectangles(std::vector<RectangleInt>& rectangles) const
+{
+  const auto n_rectangles = cairo_region_num_rectangles(m_cobject);
+  rectangles.resize(n_rectangles);
+  for(int i = 0; i < n_rectangles; ++i)
+    cairo_region_get_rectangle(m_cobject, i, &rectangles[i]);
+}
+
+std::vector<RectangleInt> Region::get_rectangles() const
+{
+  std::vector<RectangleInt> rectangles;
+  get_rectangles(rectangles);
+  return rectangles;
+}
+
 bool Region::empty() const
 {
   return cairo_region_is_empty(m_cobject);
@@ -194,6 +221,23 @@ void Region::do_xor(const RectangleInt& rectangle)
   check_status_and_throw_exception (status);
 }
 
+void Region::union_rects(const RectangleInt* rects, int count)
+{
+  if(count > 0)
+    apply_to_rectangles(m_cobject, &cairo_region_union, rects, count);
+}
+
+void Region::subtract_rects(const RectangleInt* rects, int count)
+{
+  if(count > 0)
+    apply_to_rectangles(m_cobject, &cairo_region_subtract, rects, count);
+}
+
+void Region::intersect_rects(const RectangleInt* rects, int count)
+{
+  apply_to_rectangles(m_cobject, &cairo_region_intersect, rects, count > 0 ? count : 0);
+}
+
 
 } //namespace Cairo
 
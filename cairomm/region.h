@@ -65,6 +65,14 @@ public:
   /** Creates a Region object containing the union of all given @a rects */
   static RefPtr<Region> create(const RectangleInt *rects, int count);
 
+  /** Convenience overload for contiguous containers of RectangleInt, such as
+   * std::array<RectangleInt, N>. The rectangles are passed to cairo without
+   * being copied first.
+   */
+  template <typename Container>
+  static inline RefPtr<Region> create(const Container& rects)
+  { return create(rects.data(), static_cast<int>(rects.size())); }
+
   /** allocates a new region object copied from the original */
   RefPtr<Region> copy() const;
 
@@ -79,6 +87,19 @@ public:
   /** Gets the nth rectangle from the region */
   RectangleInt get_rectangle(int nth_rectangle) const;
 
+  /** Gets all the rectangles of the region at once.
+   *
+   * @a rectangles is resized to get_num_rectangles(). Its capacity is
+   * reused, so passing the same vector again doesn't allocate once it is big
+   * enough.
+   *
+   * @param rectangles the vector to fill with the rectangles.
+   */
+  void get_rectangles(std::vector<RectangleInt>& rectangles) const;
+
+  /** Gets all the rectangles of the region at once. */
+  std::vector<RectangleInt> get_rectangles() const;
+
   /** Checks whether the region is empty */
   bool empty() const;
 
@@ -123,6 +144,55 @@ public:
    * original region or in @a rectangle, but not in both */
   void do_xor(const RectangleInt& rectangle);
 
+  /** Sets this region to the union of the region with all of @a rects.
+   *
+   * This gives the same result as calling do_union() for each rectangle, but
+   * the rectangles are sorted into bands once and merged with the region in
+   * a single pass, instead of merging the whole region once per rectangle.
+   *
+   * @param rects	the rectangles.
+   * @param count	the number of rectangles.
+   */
+  void union_rects(const RectangleInt* rects, int count);
+
+  /** Convenience overload for contiguous containers of RectangleInt, such as
+   * std::vector<RectangleInt> or std::array<RectangleInt, N>.
+   */
+  template <typename Container>
+  inline void union_rects(const Container& rects)
+  { union_rects(rects.data(), static_cast<int>(rects.size())); }
+
+  /** Subtracts all of @a rects from this region, in a single pass like
+   * union_rects().
+   *
+   * @param rects	the rectangles.
+   * @param count	the number of rectangles.
+   */
+  void subtract_rects(const RectangleInt* rects, int count);
+
+  /** Convenience overload for contiguous containers of RectangleInt, such as
+   * std::vector<RectangleInt> or std::array<RectangleInt, N>.
+   */
+  template <typename Container>
+  inline void subtract_rects(const Container& rects)
+  { subtract_rects(rects.data(), static_cast<int>(rects.size())); }
+
+  /** Sets the region to its intersection with the union of @a rects, in a
+   * single pass like union_rects(). The region becomes empty if @a count is
+   * 0.
+   *
+   * @param rects	the rectangles.
+   * @param count	the number of rectangles.
+   */
+  void intersect_rects(const RectangleInt* rects, int count);
+
+  /** Convenience overload for contiguous containers of RectangleInt, such as
+   * std::vector<RectangleInt> or std::array<RectangleInt, N>.
+   */
+  template <typename Container>
+  inline void intersect_rects(const Container& rects)
+  { intersect_rects(rects.data(), static_cast<int>(rects.size())); }
+
 
 
   typedef cairo_region_t cobject;
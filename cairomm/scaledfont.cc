@@ -19,10 +19,162 @@
 #include <cairomm/scaledfont.h>
 #include <cairomm/fontface.h>
 #include <cairomm/private.h>  // for check_status_and_throw_exception
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 namespace Cairo
 {
 
+namespace
+{
+
+const cairo_user_data_key_t USER_DATA_KEY_GLYPH_RUN_CACHE = {0};
+
+// FNV-1a, so that the cache can be searched without creating a std::string.
+std::size_t hash_utf8(const char* utf8, std::size_t length)
+{
+  std::size_t hash = 2166136261u;
+  for(std::size_t i = 0; i < length; ++i)
+  {
+    hash ^= static_cast<unsigned char>(utf8[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Glyph runs of strings converted by ScaledFont::text_to_glyphs(), relative to
+// the origin. The text, glyphs and clusters of all runs are stored one after
+// another in three arrays, and the whole cache is emptied when it becomes too
+// big.
+class GlyphRunCache
+{
+public:
+  explicit GlyphRunCache(std::size_t max_bytes)
+  : m_max_bytes(max_bytes), m_bytes(0)
+  {}
+
+  std::size_t get_max_bytes() const { return m_max_bytes; }
+
+  bool find(const char* utf8, std::size_t utf8_len, double x, double y,
+    std::vector<Glyph>& glyphs, std::vector<TextCluster>& clusters,
+    TextClusterFlags& cluster_flags) const
+  {
+    const auto hash = hash_utf8(utf8, utf8_len);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto run = find_unlocked(hash, utf8, utf8_len);
+    if(!run)
+      return false;
+
+    glyphs.resize(run->num_glyphs);
+    for(std::size_t i = 0; i < run->num_glyphs; ++i)
+    {
+      const auto& glyph = m_glyphs[run->first_glyph + i];
+      glyphs[i].index = glyph.index;
+      glyphs[i].x = glyph.x + x;
+      glyphs[i].y = glyph.y + y;
+    }
+    clusters.assign(m_clusters.begin() + run->first_cluster,
+      m_clusters.begin() + run->first_cluster + run->num_clusters);
+    cluster_flags = run->cluster_flags;
+    return true;
+  }
+
+  void insert(const char* utf8, std::size_t utf8_len, const Glyph* glyphs,
+    std::size_t num_glyphs, const TextCluster* clusters, std::size_t num_clusters,
+    TextClusterFlags cluster_flags)
+  {
+    const auto bytes = sizeof(Run) + utf8_len + num_glyphs * sizeof(Glyph) +
+      num_clusters * sizeof(TextCluster);
+    if(bytes > m_max_bytes)
+      return;
+
+    const auto hash = hash_utf8(utf8, utf8_len);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(find_unlocked(hash, utf8, utf8_len))
+      return; //Another thread converted the same string meanwhile.
+
+    if(m_bytes + bytes > m_max_bytes)
+      clear_unlocked();
+
+    Run run;
+    run.first_char = m_text.size();
+    run.num_chars = utf8_len;
+    run.first_glyph = m_glyphs.size();
+    run.num_glyphs = num_glyphs;
+    run.first_cluster = m_clusters.size();
+    run.num_clusters = num_clusters;
+    run.cluster_flags = cluster_flags;
+    m_text.append(utf8, utf8_len);
+    m_glyphs.insert(m_glyphs.end(), glyphs, glyphs + num_glyphs);
+    m_clusters.insert(m_clusters.end(), clusters, clusters + num_clusters);
+    m_runs.emplace(hash, run);
+    m_bytes += bytes;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    clear_unlocked();
+  }
+
+  static void destroy(void* data)
+  {
+    delete static_cast<GlyphRunCache*>(data);
+  }
+
+private:
+  struct Run
+  {
+    std::size_t first_char;
+    std::size_t num_chars;
+    std::size_t first_glyph;
+    std::size_t num_glyphs;
+    std::size_t first_cluster;
+    std::size_t num_clusters;
+    TextClusterFlags cluster_flags;
+  };
+
+  const Run* find_unlocked(std::size_t hash, const char* utf8, std::size_t utf8_len) const
+  {
+    auto range = m_runs.equal_range(hash);
+    for(auto i = range.first; i != range.second; ++i)
+    {
+      const auto& run = i->second;
+      if(run.num_chars == utf8_len && m_text.compare(run.first_char, utf8_len, utf8, utf8_len) == 0)
+        return &run;
+    }
+    return nullptr;
+  }
+
+  void clear_unlocked()
+  {
+    m_runs.clear();
+    m_text.clear();
+    m_glyphs.clear();
+    m_clusters.clear();
+    m_bytes = 0;
+  }
+
+  std::size_t m_max_bytes;
+  std::size_t m_bytes;
+  mutable std::mutex m_mutex;
+  std::string m_text;
+  std::vector<Glyph> m_glyphs;
+  std::vector<TextCluster> m_clusters;
+  std::unordered_multimap<std::size_t, Run> m_runs;
+};
+
+GlyphRunCache* get_glyph_run_cache(const cairo_scaled_font_t* cobject)
+{
+  return static_cast<GlyphRunCache*>(cairo_scaled_font_get_user_data(
+    const_cast<cairo_scaled_font_t*>(cobject), &USER_DATA_KEY_GLYPH_RUN_CACHE));
+}
+
+} //anonymous namespace
+
 ScaledFont::ScaledFont(cobject* cobj, bool has_reference)
 : m_cobject(nullptr)
 {
@@ -103,30 +255,69 @@ ScaledFont::text_to_glyphs (double x,
                             std::vector<TextCluster>& clusters,
                             TextClusterFlags& cluster_flags)
 {
-  int num_glyphs = -1;
-  int num_clusters = -1;
-  cairo_glyph_t* c_glyphs = nullptr;
-  cairo_text_cluster_t* c_clusters = nullptr;
-  auto status = cairo_scaled_font_text_to_glyphs(cobj(), x, y,
-                                                           utf8.c_str(),
-                                                           utf8.size(),
-                                                           &c_glyphs,
-                                                           &num_glyphs,
-                                                           &c_clusters,
-                                                           &num_clusters,
-                                                           reinterpret_cast<cairo_text_cluster_flags_t*>(&cluster_flags));
-  if (num_glyphs > 0 && c_glyphs) {
-    glyphs.assign(static_cast<Glyph*>(c_glyphs),
-                  static_cast<Glyph*>(c_glyphs + num_glyphs));
+  text_to_glyphs(x, y, utf8.data(), utf8.size(), glyphs, clusters, cluster_flags);
+}
+
+void
+ScaledFont::text_to_glyphs (double x,
+                            double y,
+                            const char* utf8,
+                            std::size_t utf8_len,
+                            std::vector<Glyph>& glyphs,
+                            std::vector<TextCluster>& clusters,
+                            TextClusterFlags& cluster_flags)
+{
+  auto cache = get_glyph_run_cache(cobj());
+  if (cache && cache->find(utf8, utf8_len, x, y, glyphs, clusters, cluster_flags))
+    return;
+
+  // let cairo write into the storage the vectors already have, so that it only
+  // allocates when the text needs more glyphs or clusters than they can hold
+  glyphs.resize(glyphs.capacity());
+  clusters.resize(clusters.capacity());
+  auto c_glyphs = glyphs.empty() ? nullptr : glyphs.data();
+  auto c_clusters = clusters.empty() ? nullptr : clusters.data();
+  int num_glyphs = glyphs.size();
+  int num_clusters = clusters.size();
+  // the cache stores glyphs relative to the origin
+  auto status = cairo_scaled_font_text_to_glyphs(cobj(),
+                                                 cache ? 0 : x,
+                                                 cache ? 0 : y,
+                                                 utf8,
+                                                 utf8_len,
+                                                 &c_glyphs,
+                                                 &num_glyphs,
+                                                 &c_clusters,
+                                                 &num_clusters,
+                                                 reinterpret_cast<cairo_text_cluster_flags_t*>(&cluster_flags));
+  num_glyphs = (c_glyphs && status == CAIRO_STATUS_SUCCESS) ? std::max(num_glyphs, 0) : 0;
+  num_clusters = (c_clusters && status == CAIRO_STATUS_SUCCESS) ? std::max(num_clusters, 0) : 0;
+
+  if (c_glyphs && c_glyphs != glyphs.data()) {
+    glyphs.assign(c_glyphs, c_glyphs + num_glyphs);
     cairo_glyph_free(c_glyphs);
   }
-  if (num_clusters > 0 && c_clusters) {
-    clusters.assign(static_cast<TextCluster*>(c_clusters),
-                    static_cast<TextCluster*>(c_clusters + num_clusters));
+  else
+    glyphs.resize(num_glyphs);
+
+  if (c_clusters && c_clusters != clusters.data()) {
+    clusters.assign(c_clusters, c_clusters + num_clusters);
     cairo_text_cluster_free(c_clusters);
   }
+  else
+    clusters.resize(num_clusters);
+
   check_status_and_throw_exception(status);
   check_object_status_and_throw_exception(*this);
+
+  if (cache) {
+    cache->insert(utf8, utf8_len, glyphs.data(), glyphs.size(),
+                  clusters.data(), clusters.size(), cluster_flags);
+    for (auto& glyph : glyphs) {
+      glyph.x += x;
+      glyph.y += y;
+    }
+  }
 }
 
 void ScaledFont::get_scale_matrix(Matrix& scale_matrix) const
@@ -135,6 +326,32 @@ void ScaledFont::get_scale_matrix(Matrix& scale_matrix) const
   check_object_status_and_throw_exception(*this);
 }
 
+void ScaledFont::set_glyph_run_cache_size(std::size_t max_bytes)
+{
+  std::unique_ptr<GlyphRunCache> cache;
+  if (max_bytes > 0)
+    cache.reset(new GlyphRunCache(max_bytes));
+
+  // replacing the user data destroys the previous cache
+  auto status = cairo_scaled_font_set_user_data(cobj(), &USER_DATA_KEY_GLYPH_RUN_CACHE,
+                                                cache.get(), &GlyphRunCache::destroy);
+  check_status_and_throw_exception(status);
+  cache.release();
+}
+
+std::size_t ScaledFont::get_glyph_run_cache_size() const
+{
+  auto cache = get_glyph_run_cache(cobj());
+  return cache ? cache->get_max_bytes() : 0;
+}
+
+void ScaledFont::clear_glyph_run_cache()
+{
+  auto cache = get_glyph_run_cache(cobj());
+  if (cache)
+    cache->clear();
+}
+
 #ifdef CAIRO_HAS_FT_FONT
 FtScaledFont::FtScaledFont(const RefPtr<FtFontFace>& font_face, const Matrix& font_matrix,
                            const Matrix& ctm, const FontOptions& options) :
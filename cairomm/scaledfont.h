@@ -24,6 +24,7 @@
 #include <cairomm/fontface.h>
 #include <cairomm/matrix.h>
 #include <cairomm/types.h>
+#include <cstddef>
 #include <vector>
 
 #ifdef CAIRO_HAS_FT_FONT
@@ -184,6 +185,10 @@ public:
    * Context::show_glyphs(), or related functions, assuming that the exact
    * same scaled font is used for the operation.
    *
+   * @a glyphs and @a clusters are resized to hold the output. Their storage is
+   * reused, so no memory is allocated when vectors that already hold enough
+   * elements are passed again, for instance when laying out text every frame.
+   *
    * @since 1.8
    **/
   void text_to_glyphs(double x,
@@ -193,6 +198,27 @@ public:
                       std::vector<TextCluster>& clusters,
                       TextClusterFlags& cluster_flags);
 
+  /** Converts UTF-8 text to an array of glyphs, with cluster mapping. This is
+   * the same as text_to_glyphs(double, double, const std::string&, std::vector<Glyph>&, std::vector<TextCluster>&, TextClusterFlags&),
+   * but the text does not need to be in a std::string.
+   *
+   * @param x X position to place first glyph.
+   * @param y Y position to place first glyph.
+   * @param utf8 a string of text encoded in UTF-8.
+   * @param utf8_len the length of @a utf8 in bytes.
+   * @param glyphs the vector to store the glyphs in. Its storage is reused.
+   * @param clusters the vector to store the cluster mapping in. Its storage is
+   * reused.
+   * @param cluster_flags cluster mapping flags
+   */
+  void text_to_glyphs(double x,
+                      double y,
+                      const char* utf8,
+                      std::size_t utf8_len,
+                      std::vector<Glyph>& glyphs,
+                      std::vector<TextCluster>& clusters,
+                      TextClusterFlags& cluster_flags);
+
   /** Stores the scale matrix of this scaled font into matrix. The scale matrix
    * is product of the font matrix and the ctm associated with the scaled font,
    * and hence is the matrix mapping from font space to device space.
@@ -203,6 +229,37 @@ public:
    */
   void get_scale_matrix(Matrix& scale_matrix) const;
 
+  /** Enables or disables the glyph run cache of this scaled font.
+   *
+   * When the cache is enabled, text_to_glyphs() remembers the glyphs and
+   * clusters of each string it converts, relative to the origin, and later
+   * calls with the same string only translate the remembered glyphs to the
+   * requested position. This avoids shaping text that is drawn again and again,
+   * such as labels that are redrawn every frame. The glyph positions may
+   * differ from uncached results by floating point rounding.
+   *
+   * The cache belongs to the underlying cairo scaled font, so it is shared by
+   * all ScaledFont objects that wrap it. When the cache grows beyond
+   * @a max_bytes it is emptied. Strings whose glyphs alone need more than
+   * @a max_bytes are not cached.
+   *
+   * This must not be called while another thread uses the same scaled font.
+   * Once the cache is enabled, text_to_glyphs() may be called from several
+   * threads.
+   *
+   * @param max_bytes the maximum memory used by the cache, or 0 to disable and
+   * free the cache.
+   */
+  void set_glyph_run_cache_size(std::size_t max_bytes);
+
+  /** Gets the maximum memory used by the glyph run cache, or 0 if the cache is
+   * disabled. See set_glyph_run_cache_size().
+   */
+  std::size_t get_glyph_run_cache_size() const;
+
+  /** Removes all glyph runs from the glyph run cache, if it is enabled. */
+  void clear_glyph_run_cache();
+
 protected:
   /* Cairo::Matrix parameters changed to cairo_matrix_t */
   ScaledFont(const RefPtr<FontFace>& font_face, const Matrix& font_matrix,
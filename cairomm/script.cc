@@ -98,6 +98,31 @@ RefPtr<Script> Script::create_for_stream(const Surface::SlotWriteFunc& write_fun
   return make_refptr_for_instance<Script>(new Script(cobject, true /* has reference */));
 }
 
+static cairo_user_data_key_t USER_DATA_KEY_DEVICE_WRITE_CLOSURE = {0};
+
+RefPtr<Script> Script::create_for_stream(cairo_write_func_t write_func, void* closure,
+                                         cairo_destroy_func_t destroy_closure)
+{
+  auto cobject = cairo_script_create_for_stream(write_func, closure);
+  auto status = cairo_device_status(cobject);
+  if(destroy_closure && status == CAIRO_STATUS_SUCCESS)
+  {
+    status = cairo_device_set_user_data(cobject, &USER_DATA_KEY_DEVICE_WRITE_CLOSURE,
+                                        closure, destroy_closure);
+    if(status != CAIRO_STATUS_SUCCESS)
+      cairo_device_destroy(cobject); //Before the closure, which it may still use.
+  }
+
+  if(status != CAIRO_STATUS_SUCCESS)
+  {
+    if(destroy_closure)
+      destroy_closure(closure);
+    throw_exception(status);
+  }
+
+  return make_refptr_for_instance<Script>(new Script(cobject, true /* has reference */));
+}
+
 #endif // CAIRO_HAS_SCRIPT_SURFACE
 
 } //namespace Cairo
@@ -127,6 +127,38 @@ public:
    */
   static RefPtr<Script> create_for_stream(const Surface::SlotWriteFunc& write_func);
 
+  /**
+   * Creates a output device for emitting the script, used when creating the
+   * individual surfaces. The script is written to @a write_func, which is
+   * called directly by cairo with @a closure.
+   *
+   * @param write_func Callback function passed the bytes written to the script
+   * @param closure The first argument of @a write_func. It must stay valid
+   * until the device is destroyed.
+   * @param destroy_closure If not null, called with @a closure when the
+   * device is destroyed, or if it could not be created.
+   */
+  static RefPtr<Script> create_for_stream(cairo_write_func_t write_func, void* closure,
+    cairo_destroy_func_t destroy_closure = nullptr);
+
+  /**
+   * Creates a output device for emitting the script, used when creating the
+   * individual surfaces. The script is written to any callable with the
+   * signature of Surface::SlotWriteFunc, such as a lambda or a function. The
+   * callable is moved into the device and called directly, without a slot.
+   * Slots and sigc++ functors still use the overload that takes a
+   * Surface::SlotWriteFunc.
+   *
+   * @param write_func Callable passed the bytes written to the script
+   */
+  template <typename T_WriteFunc,
+    typename = typename std::enable_if<Private::is_slot_free_callable<T_WriteFunc>::value>::type>
+  static inline RefPtr<Script> create_for_stream(T_WriteFunc write_func)
+  {
+    return create_for_stream(&Surface::write_func_trampoline<T_WriteFunc>,
+      new T_WriteFunc(std::move(write_func)), &Surface::delete_closure<T_WriteFunc>);
+  }
+
 };
 
 #endif // CAIRO_HAS_SCRIPT_SURFACE
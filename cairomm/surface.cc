@@ -19,6 +19,26 @@
 #include <cairomm/surface.h>
 #include <cairomm/script.h>
 #include <cairomm/private.h>
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+//Without NOMINMAX, windows.h defines min() and max() macros, which break
+//std::min() and std::max().
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace Cairo
 {
@@ -53,6 +73,30 @@ set_write_slot(cairo_surface_t* surface, Surface::SlotWriteFunc* slot) {
   cairo_surface_set_user_data(surface, &USER_DATA_KEY_WRITE_FUNC, slot, &free_slot);
 }
 
+static cairo_user_data_key_t USER_DATA_KEY_WRITE_CLOSURE = {0};
+
+// Makes a newly created stream surface own the closure of its write function,
+// or frees the closure and throws if the surface could not be created.
+static void
+take_write_closure(cairo_surface_t* surface, void* closure, cairo_destroy_func_t destroy_closure)
+{
+  auto status = cairo_surface_status(surface);
+  if(destroy_closure && status == CAIRO_STATUS_SUCCESS)
+  {
+    status = cairo_surface_set_user_data(surface, &USER_DATA_KEY_WRITE_CLOSURE,
+                                         closure, destroy_closure);
+    if(status != CAIRO_STATUS_SUCCESS)
+      cairo_surface_destroy(surface); //Before the closure, which it may still use.
+  }
+
+  if(status != CAIRO_STATUS_SUCCESS)
+  {
+    if(destroy_closure)
+      destroy_closure(closure);
+    throw_exception(status);
+  }
+}
+
 cairo_status_t read_func_wrapper(void* closure, unsigned char* data, unsigned int length)
 {
   if (!closure)
@@ -232,6 +276,65 @@ void Surface::write_to_png_stream(const SlotWriteFunc& write_func)
                                                          slot_copy /*closure*/);
   check_status_and_throw_exception(status);
 }
+
+namespace
+{
+
+cairo_status_t append_to_vector(void* closure, const unsigned char* data, unsigned int length)
+{
+  auto buffer = static_cast<std::vector<unsigned char>*>(closure);
+  try
+  {
+    buffer->insert(buffer->end(), data, data + length);
+  }
+  catch(const std::bad_alloc&)
+  {
+    return CAIRO_STATUS_NO_MEMORY;
+  }
+  return CAIRO_STATUS_SUCCESS;
+}
+
+struct FixedBuffer
+{
+  unsigned char* data;
+  std::size_t size;
+  std::size_t length;
+};
+
+cairo_status_t write_to_fixed_buffer(void* closure, const unsigned char* data, unsigned int length)
+{
+  auto buffer = static_cast<FixedBuffer*>(closure);
+  if(buffer->length < buffer->size)
+  {
+    const auto n = std::min<std::size_t>(length, buffer->size - buffer->length);
+    std::copy(data, data + n, buffer->data + buffer->length);
+  }
+  buffer->length += length;
+  return CAIRO_STATUS_SUCCESS;
+}
+
+} //anonymous namespace
+
+void Surface::write_to_png_stream(cairo_write_func_t write_func, void* closure)
+{
+  auto status = cairo_surface_write_to_png_stream(cobj(), write_func, closure);
+  check_status_and_throw_exception(status);
+}
+
+void Surface::write_to_png_buffer(std::vector<unsigned char>& buffer)
+{
+  auto status = cairo_surface_write_to_png_stream(cobj(), &append_to_vector, &buffer);
+  check_status_and_throw_exception(status);
+}
+
+bool Surface::write_to_png_buffer(unsigned char* data, std::size_t size, std::size_t& length)
+{
+  FixedBuffer buffer = {data, size, 0};
+  auto status = cairo_surface_write_to_png_stream(cobj(), &write_to_fixed_buffer, &buffer);
+  check_status_and_throw_exception(status);
+  length = buffer.length;
+  return buffer.length <= size;
+}
 #endif
 
 RefPtr<Device> Surface::get_device()
@@ -292,14 +395,14 @@ RefPtr<ImageSurface> ImageSurface::create(Format format, int width, int height)
 {
   auto cobject = cairo_image_surface_create((cairo_format_t)format, width, height);
   check_status_and_throw_exception(cairo_surface_status(cobject));
-  return make_refptr_for_instance<ImageSurface>(new ImageSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<ImageSurface>(new ImageSurface(cobject, true /* has reference */));
 }
 
 RefPtr<ImageSurface> ImageSurface::create(unsigned char* data, Format format, int width, int height, int stride)
 {
   auto cobject = cairo_image_surface_create_for_data(data, (cairo_format_t)format, width, height, stride);
   check_status_and_throw_exception(cairo_surface_status(cobject));
-  return make_refptr_for_instance<ImageSurface>(new ImageSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<ImageSurface>(new ImageSurface(cobject, true /* has reference */));
 }
 
 #ifdef CAIRO_HAS_PNG_FUNCTIONS
@@ -308,7 +411,7 @@ RefPtr<ImageSurface> ImageSurface::create_from_png(std::string filename)
 {
   auto cobject = cairo_image_surface_create_from_png(filename.c_str());
   check_status_and_throw_exception(cairo_surface_status(cobject));
-  return make_refptr_for_instance<ImageSurface>(new ImageSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<ImageSurface>(new ImageSurface(cobject, true /* has reference */));
 }
 
 RefPtr<ImageSurface> ImageSurface::create_from_png_stream(const SlotReadFunc& read_func)
@@ -318,7 +421,183 @@ RefPtr<ImageSurface> ImageSurface::create_from_png_stream(const SlotReadFunc& re
     cairo_image_surface_create_from_png_stream(&read_func_wrapper, slot_copy);
   check_status_and_throw_exception(cairo_surface_status(cobject));
   set_read_slot(cobject, slot_copy);
-  return make_refptr_for_instance<ImageSurface>(new ImageSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<ImageSurface>(new ImageSurface(cobject, true /* has reference */));
+}
+
+RefPtr<ImageSurface> ImageSurface::create_from_png_stream(cairo_read_func_t read_func, void* closure)
+{
+  auto cobject = cairo_image_surface_create_from_png_stream(read_func, closure);
+  check_status_and_throw_exception(cairo_surface_status(cobject));
+  return make_cached_refptr_for_instance<ImageSurface>(new ImageSurface(cobject, true /* has reference */));
+}
+
+namespace
+{
+
+struct MemoryReader
+{
+  const unsigned char* data;
+  std::size_t length;
+  std::size_t offset;
+};
+
+cairo_status_t read_from_memory(void* closure, unsigned char* data, unsigned int length)
+{
+  auto reader = static_cast<MemoryReader*>(closure);
+  if(length > reader->length - reader->offset)
+    return CAIRO_STATUS_READ_ERROR;
+
+  std::copy(reader->data + reader->offset, reader->data + reader->offset + length, data);
+  reader->offset += length;
+  return CAIRO_STATUS_SUCCESS;
+}
+
+//A read-only mapping of a whole file, unmapped on destruction.
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const unsigned char* get_data() const { return m_data; }
+  std::size_t get_size() const { return m_length; }
+
+private:
+  //Unmaps the file and closes it. The members are reset, so that it can be
+  //called again, which happens when throw_exception() doesn't throw.
+  void release();
+
+  const unsigned char* m_data;
+  std::size_t m_length;
+#ifdef _WIN32
+  HANDLE m_file, m_mapping;
+#else
+  int m_fd;
+#endif
+};
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filename)
+: m_data(nullptr), m_length(0), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+{
+  m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+    OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if(m_file == INVALID_HANDLE_VALUE)
+  {
+    throw_exception(CAIRO_STATUS_FILE_NOT_FOUND);
+    return;
+  }
+
+  LARGE_INTEGER size;
+  if(!GetFileSizeEx(m_file, &size))
+  {
+    release();
+    throw_exception(CAIRO_STATUS_READ_ERROR);
+    return;
+  }
+
+  m_length = static_cast<std::size_t>(size.QuadPart);
+  if(m_length == 0)
+    return;
+
+  m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if(m_mapping)
+    m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+  if(!m_data)
+  {
+    release();
+    throw_exception(CAIRO_STATUS_READ_ERROR);
+  }
+}
+
+void MappedFile::release()
+{
+  if(m_data)
+    UnmapViewOfFile(m_data);
+  if(m_mapping)
+    CloseHandle(m_mapping);
+  if(m_file != INVALID_HANDLE_VALUE)
+    CloseHandle(m_file);
+
+  m_data = nullptr;
+  m_length = 0;
+  m_mapping = nullptr;
+  m_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename)
+: m_data(nullptr), m_length(0), m_fd(-1)
+{
+  m_fd = open(filename.c_str(), O_RDONLY);
+  if(m_fd < 0)
+  {
+    throw_exception(CAIRO_STATUS_FILE_NOT_FOUND);
+    return;
+  }
+
+  struct stat info;
+  if(fstat(m_fd, &info) != 0)
+  {
+    release();
+    throw_exception(CAIRO_STATUS_READ_ERROR);
+    return;
+  }
+
+  m_length = static_cast<std::size_t>(info.st_size);
+  if(m_length == 0)
+    return;
+
+  auto mapping = mmap(nullptr, m_length, PROT_READ, MAP_PRIVATE, m_fd, 0);
+  if(mapping == MAP_FAILED)
+  {
+    release();
+    throw_exception(CAIRO_STATUS_READ_ERROR);
+    return;
+  }
+
+  //The file is decoded once from start to end.
+  madvise(mapping, m_length, MADV_SEQUENTIAL);
+  m_data = static_cast<const unsigned char*>(mapping);
+}
+
+void MappedFile::release()
+{
+  if(m_data)
+    munmap(const_cast<unsigned char*>(m_data), m_length);
+  if(m_fd >= 0)
+    close(m_fd);
+
+  m_data = nullptr;
+  m_length = 0;
+  m_fd = -1;
+}
+
+#endif //_WIN32
+
+MappedFile::~MappedFile()
+{
+  release();
+}
+
+} //anonymous namespace
+
+RefPtr<ImageSurface> ImageSurface::create_from_png_memory(const unsigned char* data, std::size_t length)
+{
+  MemoryReader reader = {data, length, 0};
+  return create_from_png_stream(&read_from_memory, &reader);
+}
+
+RefPtr<ImageSurface> ImageSurface::create_from_png_file_mmap(const std::string& filename)
+{
+  MappedFile file(filename);
+  return create_from_png_memory(file.get_data(), file.get_size());
 }
 
 #endif // CAIRO_HAS_PNG_FUNCTIONS
@@ -378,14 +657,14 @@ RefPtr<RecordingSurface> RecordingSurface::create(Content content)
 {
   auto cobject = cairo_recording_surface_create((cairo_content_t)content, NULL);
   check_status_and_throw_exception(cairo_surface_status(cobject));
-  return make_refptr_for_instance<RecordingSurface>(new RecordingSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<RecordingSurface>(new RecordingSurface(cobject, true /* has reference */));
 }
 
 RefPtr<RecordingSurface> RecordingSurface::create(const Rectangle& extents, Content content)
 {
   auto cobject = cairo_recording_surface_create((cairo_content_t)content, &extents);
   check_status_and_throw_exception(cairo_surface_status(cobject));
-  return make_refptr_for_instance<RecordingSurface>(new RecordingSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<RecordingSurface>(new RecordingSurface(cobject, true /* has reference */));
 }
 
 Rectangle RecordingSurface::ink_extents() const
@@ -405,7 +684,6 @@ bool RecordingSurface::get_extents(Rectangle& extents) const
   return has_extents;
 }
 
-
 /*******************************************************************************
  * THE FOLLOWING SURFACE TYPES ARE EXPERIMENTAL AND NOT FULLY SUPPORTED
  ******************************************************************************/
@@ -425,7 +703,7 @@ RefPtr<PdfSurface> PdfSurface::create(std::string filename, double width_in_poin
 {
   auto cobject = cairo_pdf_surface_create(filename.c_str(), width_in_points, height_in_points);
   check_status_and_throw_exception(cairo_surface_status(cobject));
-  return make_refptr_for_instance<PdfSurface>(new PdfSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<PdfSurface>(new PdfSurface(cobject, true /* has reference */));
 }
 
 RefPtr<PdfSurface> PdfSurface::create_for_stream(const SlotWriteFunc& write_func, double
@@ -437,7 +715,17 @@ RefPtr<PdfSurface> PdfSurface::create_for_stream(const SlotWriteFunc& write_func
                                         width_in_points, height_in_points);
   check_status_and_throw_exception(cairo_surface_status(cobject));
   set_write_slot(cobject, slot_copy);
-  return make_refptr_for_instance<PdfSurface>(new PdfSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<PdfSurface>(new PdfSurface(cobject, true /* has reference */));
+}
+
+RefPtr<PdfSurface> PdfSurface::create_for_stream(cairo_write_func_t write_func, void* closure,
+  double width_in_points, double height_in_points, cairo_destroy_func_t destroy_closure)
+{
+  auto cobject =
+    cairo_pdf_surface_create_for_stream(write_func, closure,
+                                        width_in_points, height_in_points);
+  take_write_closure(cobject, closure, destroy_closure);
+  return make_cached_refptr_for_instance<PdfSurface>(new PdfSurface(cobject, true /* has reference */));
 }
 
 void PdfSurface::set_size(double width_in_points, double height_in_points)
@@ -493,7 +781,7 @@ RefPtr<PsSurface> PsSurface::create(std::string filename, double width_in_points
 {
   auto cobject = cairo_ps_surface_create(filename.c_str(), width_in_points, height_in_points);
   check_status_and_throw_exception(cairo_surface_status(cobject));
-  return make_refptr_for_instance<PsSurface>(new PsSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<PsSurface>(new PsSurface(cobject, true /* has reference */));
 }
 
 RefPtr<PsSurface> PsSurface::create_for_stream(const SlotWriteFunc& write_func, double
@@ -505,7 +793,17 @@ RefPtr<PsSurface> PsSurface::create_for_stream(const SlotWriteFunc& write_func,
                                        width_in_points, height_in_points);
   check_status_and_throw_exception(cairo_surface_status(cobject));
   set_write_slot(cobject, slot_copy);
-  return make_refptr_for_instance<PsSurface>(new PsSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<PsSurface>(new PsSurface(cobject, true /* has reference */));
+}
+
+RefPtr<PsSurface> PsSurface::create_for_stream(cairo_write_func_t write_func, void* closure,
+  double width_in_points, double height_in_points, cairo_destroy_func_t destroy_closure)
+{
+  auto cobject =
+    cairo_ps_surface_create_for_stream(write_func, closure,
+                                        width_in_points, height_in_points);
+  take_write_closure(cobject, closure, destroy_closure);
+  return make_cached_refptr_for_instance<PsSurface>(new PsSurface(cobject, true /* has reference */));
 }
 
 void PsSurface::set_size(double width_in_points, double height_in_points)
@@ -594,7 +892,7 @@ RefPtr<SvgSurface> SvgSurface::create(std::string filename, double width_in_poin
 {
   auto cobject = cairo_svg_surface_create(filename.c_str(), width_in_points, height_in_points);
   check_status_and_throw_exception(cairo_surface_status(cobject));
-  return make_refptr_for_instance<SvgSurface>(new SvgSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<SvgSurface>(new SvgSurface(cobject, true /* has reference */));
 }
 
 RefPtr<SvgSurface> SvgSurface::create_for_stream(const SlotWriteFunc& write_func,
@@ -607,7 +905,17 @@ RefPtr<SvgSurface> SvgSurface::create_for_stream(const SlotWriteFunc& write_func
                                         width_in_points, height_in_points);
   check_status_and_throw_exception(cairo_surface_status(cobject));
   set_write_slot(cobject, slot_copy);
-  return make_refptr_for_instance<SvgSurface>(new SvgSurface(cobject, true /* has reference */));
+  return make_cached_refptr_for_instance<SvgSurface>(new SvgSurface(cobject, true /* has reference */));
+}
+
+RefPtr<SvgSurface> SvgSurface::create_for_stream(cairo_write_func_t write_func, void* closure,
+  double width_in_points, double height_in_points, cairo_destroy_func_t destroy_closure)
+{
+  auto cobject =
+    cairo_svg_surface_create_for_stream(write_func, closure,
+                                        width_in_points, height_in_points);
+  take_write_closure(cobject, closure, destroy_closure);
+  return make_cached_refptr_for_instance<SvgSurface>(new SvgSurface(cobject, true /* has reference */));
 }
 
 void SvgSurface::restrict_to_version(SvgVersion version)
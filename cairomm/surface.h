@@ -20,6 +20,8 @@
 #define __CAIROMM_SURFACE_H
 
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 /* following is required for OS X */
@@ -27,9 +29,13 @@
 #ifdef nil
 #undef nil
 #include <sigc++/slot.h>
+#include <sigc++/functors/mem_fun.h>
+#include <sigc++/functors/ptr_fun.h>
 #define nil NULL
 #else
 #include <sigc++/slot.h>
+#include <sigc++/functors/mem_fun.h>
+#include <sigc++/functors/ptr_fun.h>
 #endif
 
 /* end OS X */
@@ -63,6 +69,33 @@
 namespace Cairo
 {
 
+#ifndef DOXYGEN_IGNORE_THIS
+namespace Private
+{
+
+template <typename T, template <typename...> class T_Template>
+struct is_specialization_of : std::false_type
+{};
+
+template <template <typename...> class T_Template, typename... T_Args>
+struct is_specialization_of<T_Template<T_Args...>, T_Template> : std::true_type
+{};
+
+//Whether the slot-free stream templates take a callable of type T_Func.
+//Slots and the functors of sigc++ are left to the overloads that take a
+//slot, so that code written for those keeps calling them.
+template <typename T_Func>
+struct is_slot_free_callable
+  : std::integral_constant<bool,
+      !std::is_base_of<sigc::slot_base, T_Func>::value &&
+      !is_specialization_of<T_Func, sigc::pointer_functor>::value &&
+      !is_specialization_of<T_Func, sigc::mem_functor>::value &&
+      !is_specialization_of<T_Func, sigc::bound_mem_functor>::value>
+{};
+
+} // namespace Private
+#endif //DOXYGEN_IGNORE_THIS
+
 /** A cairo surface represents an image, either as the destination of a drawing
  * operation or as source when drawing onto another surface. There are
  * different subtypes of cairo surface for different drawing backends.  This
@@ -107,6 +140,22 @@ public:
    */
   typedef sigc::slot<ErrorStatus(unsigned char* /*data*/, unsigned int /*length*/)> SlotReadFunc;
 
+#ifndef DOXYGEN_IGNORE_THIS
+  ///For use only by the cairomm implementation.
+  //Adapts any callable to cairo's C callbacks without a sigc::slot.
+  template <typename T_WriteFunc>
+  static cairo_status_t write_func_trampoline(void* closure, const unsigned char* data, unsigned int length)
+  { return static_cast<cairo_status_t>((*static_cast<T_WriteFunc*>(closure))(data, length)); }
+
+  template <typename T_ReadFunc>
+  static cairo_status_t read_func_trampoline(void* closure, unsigned char* data, unsigned int length)
+  { return static_cast<cairo_status_t>((*static_cast<T_ReadFunc*>(closure))(data, length)); }
+
+  template <typename T_Func>
+  static void delete_closure(void* closure)
+  { delete static_cast<T_Func*>(closure); }
+#endif //DOXYGEN_IGNORE_THIS
+
   /** Create a C++ wrapper for the C instance. This C++ instance should then be
    * given to a RefPtr.
    *
@@ -346,6 +395,66 @@ public:
    */
   void write_to_png_stream(const SlotWriteFunc& write_func);
 
+  /** Writes the Surface to the write function, which is called directly by
+   * cairo with @a closure.
+   *
+   * @note For this function to be available, cairo must have been compiled
+   * with PNG support
+   *
+   * @param write_func  The function to be called when the backend needs to
+   * write data to an output stream
+   * @param closure  The first argument of @a write_func
+   */
+  void write_to_png_stream(cairo_write_func_t write_func, void* closure);
+
+  /** Writes the Surface to any callable with the signature of SlotWriteFunc,
+   * such as a lambda or a function. The callable is copied, and the copy is
+   * called directly, without a slot. Pass it with std::ref() to call the
+   * original instead. Slots and sigc++ functors still use
+   * write_to_png_stream(const SlotWriteFunc&).
+   *
+   * @note For this function to be available, cairo must have been compiled
+   * with PNG support
+   *
+   * @param write_func  The callable to be called when the backend needs to
+   * write data to an output stream
+   */
+  template <typename T_WriteFunc,
+    typename = typename std::enable_if<Private::is_slot_free_callable<T_WriteFunc>::value>::type>
+  inline void write_to_png_stream(T_WriteFunc write_func)
+  {
+    write_to_png_stream(&write_func_trampoline<T_WriteFunc>, &write_func);
+  }
+
+  /** Writes the contents of surface as a PNG image to the end of @a buffer.
+   *
+   * This is faster than collecting the data with write_to_png_stream(),
+   * because each chunk of data is appended directly, without calling a slot.
+   * Reuse the same buffer, after clearing it, to avoid reallocations.
+   *
+   * @note For this function to be available, cairo must have been compiled
+   * with PNG support
+   *
+   * @param buffer	the vector to append the PNG data to
+   */
+  void write_to_png_buffer(std::vector<unsigned char>& buffer);
+
+  /** Writes the contents of surface as a PNG image to a fixed-size buffer,
+   * such as memory from an arena.
+   *
+   * If the image doesn't fit, the data that fits is written, and the rest is
+   * only counted, so that @a length is the size needed for a retry.
+   *
+   * @note For this function to be available, cairo must have been compiled
+   * with PNG support
+   *
+   * @param data	the buffer to write the PNG data to
+   * @param size	the size of @a data, in bytes
+   * @param length	set to the size of the PNG data, in bytes
+   * @return true if the whole image fit in @a data.
+   */
+  bool write_to_png_buffer(unsigned char* data, std::size_t size, std::size_t& length);
+
 #endif // CAIRO_HAS_PNG_FUNCTIONS
 
   /** This function returns the device for a surface
@@ -574,6 +683,72 @@ public:
    */
   static RefPtr<ImageSurface> create_from_png_stream(const SlotReadFunc& read_func);
 
+  /** Creates a new image surface from PNG data read incrementally via the
+   * read_func function, which is called directly by cairo with @a closure.
+   *
+   * @note For this function to be available, cairo must have been compiled
+   * with PNG support.
+   *
+   * @param read_func function called to read the data of the file
+   * @param closure the first argument of @a read_func
+   * @return a RefPtr to the new cairo_surface_t initialized with the
+   * contents of the PNG image file.
+   */
+  static RefPtr<ImageSurface> create_from_png_stream(cairo_read_func_t read_func, void* closure);
+
+  /** Creates a new image surface from PNG data in memory.
+   *
+   * The data is copied to cairo through a read function, in the chunks that
+   * cairo asks for, without first being copied into a stream or a string.
+   * The data only needs to stay valid during this call.
+   *
+   * @note For this function to be available, cairo must have been compiled
+   * with PNG support.
+   *
+   * @param data the PNG data
+   * @param length the length of @a data, in bytes
+   * @return a RefPtr to the new cairo_surface_t initialized with the
+   * contents of the PNG image.
+   */
+  static RefPtr<ImageSurface> create_from_png_memory(const unsigned char* data, std::size_t length);
+
+  /** Creates a new image surface from a PNG file, by mapping the file into
+   * memory and decoding it from there.
+   *
+   * Unlike create_from_png(), the file data is not copied through stdio
+   * buffers, and the mapped pages can be dropped by the system as soon as
+   * they have been decoded.
+   *
+   * @note For this function to be available, cairo must have been compiled
+   * with PNG support.
+   *
+   * @param filename name of PNG file to load
+   * @return a RefPtr to the new cairo_surface_t initialized with the
+   * contents of the PNG image file.
+   */
+  static RefPtr<ImageSurface> create_from_png_file_mmap(const std::string& filename);
+
+  /** Creates a new image surface from PNG data read incrementally by any
+   * callable with the signature of SlotReadFunc, such as a lambda or a
+   * function. The callable is copied, and the copy is called directly,
+   * without a slot. Pass it with std::ref() to call the original instead.
+   * Slots and sigc++ functors still use
+   * create_from_png_stream(const SlotReadFunc&).
+   *
+   * @note For this function to be available, cairo must have been compiled
+   * with PNG support.
+   *
+   * @param read_func callable called to read the data of the file
+   * @return a RefPtr to the new cairo_surface_t initialized with the
+   * contents of the PNG image file.
+   */
+  template <typename T_ReadFunc,
+    typename = typename std::enable_if<Private::is_slot_free_callable<T_ReadFunc>::value>::type>
+  static inline RefPtr<ImageSurface> create_from_png_stream(T_ReadFunc read_func)
+  {
+    return create_from_png_stream(&read_func_trampoline<T_ReadFunc>, &read_func);
+  }
+
 #endif // CAIRO_HAS_PNG_FUNCTIONS
 
 };
@@ -734,6 +909,42 @@ public:
    */
   static RefPtr<PdfSurface> create_for_stream(const SlotWriteFunc& write_func, double width_in_points, double height_in_points);
 
+  /** Creates a PdfSurface with a specified dimensions that will be written to
+   * @a write_func, which is called directly by cairo with @a closure.
+   *
+   * @param write_func  The function to be called when the backend needs to
+   * write data to an output stream
+   * @param closure  The first argument of @a write_func. It must stay valid
+   * until the surface is destroyed.
+   * @param width_in_points   The width of the PDF document in points
+   * @param height_in_points   The height of the PDF document in points
+   * @param destroy_closure  If not null, called with @a closure when the
+   * surface is destroyed, or if it could not be created.
+   */
+  static RefPtr<PdfSurface> create_for_stream(cairo_write_func_t write_func, void* closure,
+    double width_in_points, double height_in_points,
+    cairo_destroy_func_t destroy_closure = nullptr);
+
+  /** Creates a PdfSurface with a specified dimensions that will be written to
+   * any callable with the signature of SlotWriteFunc, such as a lambda or a
+   * function. The callable is moved into the surface and called directly,
+   * without a slot. Slots and sigc++ functors still use the overload that
+   * takes a SlotWriteFunc.
+   *
+   * @param write_func  The callable to be called when the backend needs to
+   * write data to an output stream
+   * @param width_in_points   The width of the PDF document in points
+   * @param height_in_points   The height of the PDF document in points
+   */
+  template <typename T_WriteFunc,
+    typename = typename std::enable_if<Private::is_slot_free_callable<T_WriteFunc>::value>::type>
+  static inline RefPtr<PdfSurface> create_for_stream(T_WriteFunc write_func, double width_in_points, double height_in_points)
+  {
+    return create_for_stream(&write_func_trampoline<T_WriteFunc>,
+      new T_WriteFunc(std::move(write_func)), width_in_points, height_in_points,
+      &delete_closure<T_WriteFunc>);
+  }
+
 /**
  * Changes the size of a PDF surface for the current (and subsequent) pages.
  *
@@ -835,6 +1046,42 @@ public:
    */
   static RefPtr<PsSurface> create_for_stream(const SlotWriteFunc& write_func, double width_in_points, double height_in_points);
 
+  /** Creates a PsSurface with a specified dimensions that will be written to
+   * @a write_func, which is called directly by cairo with @a closure.
+   *
+   * @param write_func  The function to be called when the backend needs to
+   * write data to an output stream
+   * @param closure  The first argument of @a write_func. It must stay valid
+   * until the surface is destroyed.
+   * @param width_in_points   The width of the PostScript document in points
+   * @param height_in_points   The height of the PostScript document in points
+   * @param destroy_closure  If not null, called with @a closure when the
+   * surface is destroyed, or if it could not be created.
+   */
+  static RefPtr<PsSurface> create_for_stream(cairo_write_func_t write_func, void* closure,
+    double width_in_points, double height_in_points,
+    cairo_destroy_func_t destroy_closure = nullptr);
+
+  /** Creates a PsSurface with a specified dimensions that will be written to
+   * any callable with the signature of SlotWriteFunc, such as a lambda or a
+   * function. The callable is moved into the surface and called directly,
+   * without a slot. Slots and sigc++ functors still use the overload that
+   * takes a SlotWriteFunc.
+   *
+   * @param write_func  The callable to be called when the backend needs to
+   * write data to an output stream
+   * @param width_in_points   The width of the PostScript document in points
+   * @param height_in_points   The height of the PostScript document in points
+   */
+  template <typename T_WriteFunc,
+    typename = typename std::enable_if<Private::is_slot_free_callable<T_WriteFunc>::value>::type>
+  static inline RefPtr<PsSurface> create_for_stream(T_WriteFunc write_func, double width_in_points, double height_in_points)
+  {
+    return create_for_stream(&write_func_trampoline<T_WriteFunc>,
+      new T_WriteFunc(std::move(write_func)), width_in_points, height_in_points,
+      &delete_closure<T_WriteFunc>);
+  }
+
   /**
    * Changes the size of a PostScript surface for the current (and
    * subsequent) pages.
@@ -989,6 +1236,42 @@ public:
    */
   static RefPtr<SvgSurface> create_for_stream(const SlotWriteFunc& write_func, double width_in_points, double height_in_points);
 
+  /** Creates a SvgSurface with a specified dimensions that will be written to
+   * @a write_func, which is called directly by cairo with @a closure.
+   *
+   * @param write_func  The function to be called when the backend needs to
+   * write data to an output stream
+   * @param closure  The first argument of @a write_func. It must stay valid
+   * until the surface is destroyed.
+   * @param width_in_points   The width of the SVG document in points
+   * @param height_in_points   The height of the SVG document in points
+   * @param destroy_closure  If not null, called with @a closure when the
+   * surface is destroyed, or if it could not be created.
+   */
+  static RefPtr<SvgSurface> create_for_stream(cairo_write_func_t write_func, void* closure,
+    double width_in_points, double height_in_points,
+    cairo_destroy_func_t destroy_closure = nullptr);
+
+  /** Creates a SvgSurface with a specified dimensions that will be written to
+   * any callable with the signature of SlotWriteFunc, such as a lambda or a
+   * function. The callable is moved into the surface and called directly,
+   * without a slot. Slots and sigc++ functors still use the overload that
+   * takes a SlotWriteFunc.
+   *
+   * @param write_func  The callable to be called when the backend needs to
+   * write data to an output stream
+   * @param width_in_points   The width of the SVG document in points
+   * @param height_in_points   The height of the SVG document in points
+   */
+  template <typename T_WriteFunc,
+    typename = typename std::enable_if<Private::is_slot_free_callable<T_WriteFunc>::value>::type>
+  static inline RefPtr<SvgSurface> create_for_stream(T_WriteFunc write_func, double width_in_points, double height_in_points)
+  {
+    return create_for_stream(&write_func_trampoline<T_WriteFunc>,
+      new T_WriteFunc(std::move(write_func)), width_in_points, height_in_points,
+      &delete_closure<T_WriteFunc>);
+  }
+
   /**
    * Restricts the generated SVG file to the given version. See get_versions()
    * for a list of available version values that can be used here.
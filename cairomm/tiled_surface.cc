@@ -0,0 +1,191 @@
+/* Copyright (C) 2026 The cairomm Development Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <cairomm/tiled_surface.h>
+#include <cairomm/private.h>
+#include <algorithm>
+
+namespace Cairo
+{
+
+TiledSurface::TiledSurface(const RefPtr<ImageSurface>& target, int tile_width, int tile_height)
+: m_target(target),
+  m_dirty(Region::create()),
+  m_tile_width(tile_width),
+  m_tile_height(tile_height),
+  m_num_columns(0),
+  m_num_rows(0)
+{
+  if(tile_width <= 0 || tile_height <= 0)
+    throw_exception(CAIRO_STATUS_INVALID_SIZE);
+
+  m_num_columns = (target->get_width() + tile_width - 1) / tile_width;
+  m_num_rows = (target->get_height() + tile_height - 1) / tile_height;
+}
+
+TiledSurface::~TiledSurface()
+{
+}
+
+RefPtr<ImageSurface> TiledSurface::get_target()
+{
+  return m_target;
+}
+
+RefPtr<const ImageSurface> TiledSurface::get_target() const
+{
+  return m_target;
+}
+
+int TiledSurface::get_tile_width() const
+{
+  return m_tile_width;
+}
+
+int TiledSurface::get_tile_height() const
+{
+  return m_tile_height;
+}
+
+int TiledSurface::get_num_columns() const
+{
+  return m_num_columns;
+}
+
+int TiledSurface::get_num_rows() const
+{
+  return m_num_rows;
+}
+
+TiledSurface::Tile TiledSurface::get_tile(int column, int row) const
+{
+  Tile tile;
+  tile.column = column;
+  tile.row = row;
+  tile.rectangle.x = column * m_tile_width;
+  tile.rectangle.y = row * m_tile_height;
+  tile.rectangle.width = std::min(m_tile_width, m_target->get_width() - tile.rectangle.x);
+  tile.rectangle.height = std::min(m_tile_height, m_target->get_height() - tile.rectangle.y);
+  return tile;
+}
+
+void TiledSurface::invalidate(const RectangleInt& rectangle)
+{
+  m_dirty->do_union(rectangle);
+  m_dirty->intersect(RectangleInt{0, 0, m_target->get_width(), m_target->get_height()});
+}
+
+void TiledSurface::invalidate(const RefPtr<const Region>& region)
+{
+  cairo_region_union(m_dirty->cobj(), const_cast<cairo_region_t*>(region->cobj()));
+  check_object_status_and_throw_exception(*m_dirty);
+  m_dirty->intersect(RectangleInt{0, 0, m_target->get_width(), m_target->get_height()});
+}
+
+void TiledSurface::invalidate_all()
+{
+  invalidate(RectangleInt{0, 0, m_target->get_width(), m_target->get_height()});
+}
+
+RefPtr<const Region> TiledSurface::get_dirty_region() const
+{
+  return m_dirty;
+}
+
+bool TiledSurface::is_dirty() const
+{
+  return !m_dirty->empty();
+}
+
+std::vector<TiledSurface::Tile> TiledSurface::get_dirty_tiles() const
+{
+  std::vector<Tile> tiles;
+  const auto n_rectangles = m_dirty->get_num_rectangles();
+  if(n_rectangles == 0)
+    return tiles;
+
+  //The rectangles of a region are sorted by y and then x and don't overlap,
+  //but several of them can touch the same tile, so tiles are marked first.
+  std::vector<bool> marked(static_cast<std::size_t>(m_num_columns) * m_num_rows, false);
+  int min_row = m_num_rows, max_row = -1;
+  for(int i = 0; i < n_rectangles; ++i)
+  {
+    const auto rectangle = m_dirty->get_rectangle(i);
+    if(rectangle.width <= 0 || rectangle.height <= 0)
+      continue;
+
+    const int first_column = rectangle.x / m_tile_width;
+    const int last_column = (rectangle.x + rectangle.width - 1) / m_tile_width;
+    const int first_row = rectangle.y / m_tile_height;
+    const int last_row = (rectangle.y + rectangle.height - 1) / m_tile_height;
+    for(int row = first_row; row <= last_row; ++row)
+    {
+      for(int column = first_column; column <= last_column; ++column)
+        marked[static_cast<std::size_t>(row) * m_num_columns + column] = true;
+    }
+
+    min_row = std::min(min_row, first_row);
+    max_row = std::max(max_row, last_row);
+  }
+
+  for(int row = min_row; row <= max_row; ++row)
+  {
+    for(int column = 0; column < m_num_columns; ++column)
+    {
+      if(marked[static_cast<std::size_t>(row) * m_num_columns + column])
+        tiles.push_back(get_tile(column, row));
+    }
+  }
+
+  return tiles;
+}
+
+RefPtr<Context> TiledSurface::create_tile_context(const Tile& tile)
+{
+  auto context = Context::create(m_target);
+  const auto& rectangle = tile.rectangle;
+  context->rectangle(rectangle.x, rectangle.y, rectangle.width, rectangle.height);
+  context->clip();
+  return context;
+}
+
+void TiledSurface::mark_clean(const Tile& tile)
+{
+  m_dirty->subtract(tile.rectangle);
+}
+
+void TiledSurface::mark_all_clean()
+{
+  //Cleared in place, so that the region returned by get_dirty_region()
+  //stays up to date.
+  if(!m_dirty->empty())
+    m_dirty->subtract(m_dirty->get_extents());
+}
+
+void TiledSurface::redraw(const SlotDrawTile& slot)
+{
+  for(const auto& tile : get_dirty_tiles())
+  {
+    slot(create_tile_context(tile), tile);
+    mark_clean(tile);
+  }
+}
+
+} //namespace Cairo
+
+// vim: ts=2 sw=2 et
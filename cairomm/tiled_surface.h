@@ -0,0 +1,161 @@
+/* Copyright (C) 2026 The cairomm Development Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __CAIROMM_TILED_SURFACE_H
+#define __CAIROMM_TILED_SURFACE_H
+
+#include <cairomm/context.h>
+#include <cairomm/region.h>
+#include <cairomm/surface.h>
+#include <sigc++/slot.h>
+#include <vector>
+
+namespace Cairo
+{
+
+/**
+ * Splits an ImageSurface into a grid of fixed-size tiles and keeps track of
+ * which of them need to be redrawn.
+ *
+ * Damage is added with invalidate() and collected in a Region. Only the tiles
+ * that intersect the damage are returned by get_dirty_tiles(), so the cost of
+ * a redraw depends on the size of the change, not the size of the surface.
+ *
+ * @code
+ * Cairo::TiledSurface tiles(image, 256, 256);
+ * tiles.invalidate(changed_area);
+ * tiles.redraw([&](const Cairo::RefPtr<Cairo::Context>& cr,
+ *                  const Cairo::TiledSurface::Tile& tile)
+ * {
+ *   draw_scene(cr); //Drawing outside the tile is clipped away.
+ *   encode(tile.rectangle);
+ * });
+ * @endcode
+ *
+ * The tiles at the right and bottom edges are smaller if the surface size is
+ * not a multiple of the tile size.
+ */
+class TiledSurface
+{
+public:
+  /** One tile of a TiledSurface. */
+  struct Tile
+  {
+    /// The column of the tile in the grid.
+    int column;
+    /// The row of the tile in the grid.
+    int row;
+    /// The area covered by the tile, in surface coordinates.
+    RectangleInt rectangle;
+  };
+
+  /** For instance,
+   * void on_draw_tile(const Cairo::RefPtr<Cairo::Context>& cr, const Cairo::TiledSurface::Tile& tile);
+   */
+  typedef sigc::slot<void(const RefPtr<Context>& /*context*/, const Tile& /*tile*/)> SlotDrawTile;
+
+  /** Creates a tile grid over @a target. Initially no tile is dirty.
+   *
+   * @param target the surface to split into tiles
+   * @param tile_width the width of each tile, in pixels
+   * @param tile_height the height of each tile, in pixels
+   *
+   * @exception Cairo::logic_error if a tile size is not positive.
+   */
+  TiledSurface(const RefPtr<ImageSurface>& target, int tile_width, int tile_height);
+
+  TiledSurface(const TiledSurface&) = delete;
+  TiledSurface& operator=(const TiledSurface&) = delete;
+
+  virtual ~TiledSurface();
+
+  /** Gets the surface that is split into tiles. */
+  RefPtr<ImageSurface> get_target();
+  RefPtr<const ImageSurface> get_target() const;
+
+  int get_tile_width() const;
+  int get_tile_height() const;
+
+  /** Gets the number of columns of tiles. */
+  int get_num_columns() const;
+
+  /** Gets the number of rows of tiles. */
+  int get_num_rows() const;
+
+  /** Gets the tile at the given position in the grid. */
+  Tile get_tile(int column, int row) const;
+
+  /** Marks an area of the surface as needing to be redrawn. Parts of
+   * @a rectangle outside the surface are ignored.
+   */
+  void invalidate(const RectangleInt& rectangle);
+
+  /** Marks an area of the surface as needing to be redrawn. Parts of
+   * @a region outside the surface are ignored.
+   */
+  void invalidate(const RefPtr<const Region>& region);
+
+  /** Marks the whole surface as needing to be redrawn. */
+  void invalidate_all();
+
+  /** Gets the area that has been invalidated since it was last redrawn.
+   * The returned region is updated as tiles are invalidated and redrawn.
+   */
+  RefPtr<const Region> get_dirty_region() const;
+
+  /** Checks whether any area needs to be redrawn. */
+  bool is_dirty() const;
+
+  /** Gets the tiles that intersect the dirty region, ordered by row and then
+   * by column. Each tile is listed once.
+   */
+  std::vector<Tile> get_dirty_tiles() const;
+
+  /** Creates a Context that draws onto @a tile only.
+   *
+   * The Context uses the coordinates of the whole surface and is clipped to
+   * the rectangle of the tile.
+   */
+  RefPtr<Context> create_tile_context(const Tile& tile);
+
+  /** Marks @a tile as redrawn by removing its area from the dirty region. */
+  void mark_clean(const Tile& tile);
+
+  /** Marks the whole surface as redrawn. */
+  void mark_all_clean();
+
+  /** Calls @a slot for each dirty tile with a Context created by
+   * create_tile_context(), then marks the tiles as clean.
+   *
+   * If @a slot throws an exception, the tiles that have not been drawn yet
+   * stay dirty.
+   */
+  void redraw(const SlotDrawTile& slot);
+
+protected:
+  RefPtr<ImageSurface> m_target;
+  RefPtr<Region> m_dirty;
+  int m_tile_width, m_tile_height;
+  int m_num_columns, m_num_rows;
+};
+
+} // namespace Cairo
+
+#endif //__CAIROMM_TILED_SURFACE_H
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,264 @@
+// vim: ts=2 sw=2 et
+/*
+ * These tests count the C++ heap allocations made by calls that are expected
+ * to be made very often, such as getters used in tight drawing loops.
+ * Allocations done by cairo itself (with malloc()) are not counted.
+ */
+
+#include <cstdlib>
+#include <new>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+using namespace boost::unit_test;
+#include <cairommconfig.h>
+#include <cairomm/context.h>
+#include <cairomm/fontface.h>
+#include <cairomm/region.h>
+#include <cairomm/scaledfont.h>
+#include <cstring>
+#include <vector>
+
+static unsigned long allocation_count = 0;
+
+void* operator new(std::size_t size)
+{
+  ++allocation_count;
+  if(auto p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+static const int ITERATIONS = 100000;
+
+void
+test_get_target ()
+{
+  auto surf = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 10, 10);
+  auto cr = Cairo::Context::create(surf);
+
+  const auto before = allocation_count;
+  for(int i = 0; i < ITERATIONS; ++i)
+    cr->get_target();
+  const auto allocations = allocation_count - before;
+  BOOST_CHECK_EQUAL (0ul, allocations);
+}
+
+void
+test_get_source ()
+{
+  auto surf = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 10, 10);
+  auto cr = Cairo::Context::create(surf);
+  cr->set_source_rgb(1.0, 0.5, 0.25);
+
+  // the first call creates the wrapper, later calls only look it up
+  auto source = cr->get_source();
+  const auto before = allocation_count;
+  for(int i = 0; i < ITERATIONS; ++i)
+    cr->get_source();
+  const auto allocations = allocation_count - before;
+  BOOST_CHECK_EQUAL (0ul, allocations);
+}
+
+void
+test_refptr_copy ()
+{
+  auto surf = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 10, 10);
+  std::vector<Cairo::RefPtr<Cairo::Surface> > copies(ITERATIONS);
+
+  const auto before = allocation_count;
+  for(auto& copy : copies)
+    copy = surf;
+  const auto allocations = allocation_count - before;
+  BOOST_CHECK_EQUAL (0ul, allocations);
+
+#ifdef CAIROMM_INTRUSIVE_REFPTR
+  // every copy is one reference of the cairo object itself
+  BOOST_CHECK_EQUAL (ITERATIONS + 1u, cairo_surface_get_reference_count(surf->cobj()));
+  copies.clear();
+  BOOST_CHECK_EQUAL (1u, cairo_surface_get_reference_count(surf->cobj()));
+#endif
+}
+
+void
+test_refptr_create ()
+{
+  const auto before = allocation_count;
+  auto pattern = Cairo::SolidPattern::create_rgb(1.0, 0.5, 0.25);
+  const auto allocations = allocation_count - before;
+
+#ifdef CAIROMM_INTRUSIVE_REFPTR
+  // just the wrapper, no shared_ptr control block and no cache slot
+  BOOST_CHECK_EQUAL (1ul, allocations);
+#else
+  BOOST_CHECK (allocations >= 2ul);
+#endif
+}
+
+void
+test_text_to_glyphs ()
+{
+  auto face = Cairo::ToyFontFace::create("sans", Cairo::FONT_SLANT_NORMAL, Cairo::FONT_WEIGHT_NORMAL);
+  auto font = Cairo::ScaledFont::create(face, Cairo::scaling_matrix(10, 10), Cairo::identity_matrix());
+  const std::string text = "a label that is longer than the small string buffer";
+  const char* chars = "0.25";
+  std::vector<Cairo::Glyph> glyphs;
+  std::vector<Cairo::TextCluster> clusters;
+  Cairo::TextClusterFlags flags;
+
+  for(auto cache_size : {0, 65536})
+  {
+    font->set_glyph_run_cache_size(cache_size);
+
+    // the first calls size the buffers, later calls reuse them
+    font->text_to_glyphs(0, 0, text, glyphs, clusters, flags);
+    font->text_to_glyphs(0, 0, chars, std::strlen(chars), glyphs, clusters, flags);
+    const auto before = allocation_count;
+    for(int i = 0; i < ITERATIONS; ++i)
+    {
+      font->text_to_glyphs(i, 10, text, glyphs, clusters, flags);
+      font->text_to_glyphs(i, 20, chars, std::strlen(chars), glyphs, clusters, flags);
+    }
+    const auto allocations = allocation_count - before;
+    BOOST_CHECK_EQUAL (0ul, allocations);
+    BOOST_CHECK_EQUAL (4u, glyphs.size());
+  }
+}
+
+class NullRenderUserFont : public Cairo::UserFontFace
+{
+public:
+  static Cairo::RefPtr<NullRenderUserFont> create()
+  { return Cairo::make_refptr_for_instance<NullRenderUserFont>(new NullRenderUserFont()); }
+
+  Cairo::ErrorStatus
+  render_glyph(const Cairo::RefPtr<Cairo::ScaledFont>& /*scaled_font*/,
+               unsigned long /*glyph*/,
+               const Cairo::RefPtr<Cairo::Context>& /*cr*/,
+               Cairo::TextExtents& /*metrics*/) override
+  { ++count_render_glyph; return CAIRO_STATUS_SUCCESS; }
+
+  Cairo::ErrorStatus
+  text_to_glyphs(const Cairo::RefPtr<Cairo::ScaledFont>& /*scaled_font*/,
+                 const std::string& utf8,
+                 std::vector<Cairo::Glyph>& glyphs,
+                 std::vector<Cairo::TextCluster>& clusters,
+                 Cairo::TextClusterFlags& /*cluster_flags*/) override
+  {
+    // one glyph per byte, so that the clusters are valid for ASCII text
+    for(std::size_t i = 0; i < utf8.size(); ++i)
+    {
+      glyphs.push_back({static_cast<unsigned long>(utf8[i]), 10.0 * i, 0.0});
+      clusters.push_back({1, 1});
+    }
+    return CAIRO_STATUS_SUCCESS;
+  }
+
+  int count_render_glyph = 0;
+};
+
+void
+test_user_font_callbacks ()
+{
+  auto surf = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 10, 10);
+  auto cr = Cairo::Context::create(surf);
+  auto face = NullRenderUserFont::create();
+  cr->set_font_face(face);
+  auto font = Cairo::ScaledFont::create(face, Cairo::scaling_matrix(10, 10), Cairo::identity_matrix());
+
+  // the first glyph sets up the scaled font
+  std::vector<Cairo::Glyph> glyphs(1, Cairo::Glyph{0, 0.0, 0.0});
+  cr->show_glyphs(glyphs);
+  std::vector<Cairo::TextCluster> clusters;
+  Cairo::TextClusterFlags flags;
+  font->text_to_glyphs(0, 0, "label", glyphs, clusters, flags);
+
+  // every glyph index is new, so every call renders a glyph
+  const auto before = allocation_count;
+  for(int i = 1; i <= 1000; ++i)
+  {
+    glyphs.assign(1, Cairo::Glyph{static_cast<unsigned long>(i), 0.0, 0.0});
+    cr->show_glyphs(glyphs);
+    font->text_to_glyphs(0, 0, "label", glyphs, clusters, flags);
+  }
+  const auto allocations = allocation_count - before;
+  BOOST_CHECK_EQUAL (0ul, allocations);
+  BOOST_CHECK (face->count_render_glyph > 1000);
+}
+
+void
+test_region_rectangles ()
+{
+  std::vector<Cairo::RectangleInt> rects;
+  for(int i = 0; i < 10000; ++i)
+    rects.push_back(Cairo::RectangleInt{(i % 100) * 20, (i / 100) * 20, 10, 10});
+
+  // the rectangles are not copied, only the wrapper is allocated
+  auto before = allocation_count;
+  auto empty = Cairo::Region::create();
+  const auto wrapper_allocations = allocation_count - before;
+  before = allocation_count;
+  auto region = Cairo::Region::create(rects);
+  BOOST_CHECK_EQUAL (wrapper_allocations, allocation_count - before);
+
+  std::vector<Cairo::RectangleInt> result;
+  region->get_rectangles(result);
+  BOOST_CHECK_EQUAL (rects.size(), result.size());
+  before = allocation_count;
+  for(int i = 0; i < 100; ++i)
+    region->get_rectangles(result);
+  const auto allocations = allocation_count - before;
+  BOOST_CHECK_EQUAL (0ul, allocations);
+}
+
+// cairo still mallocs the list of rectangles for each query, which is not
+// counted here. This only checks that the wrappers don't add C++ allocations
+// of their own once the vector is big enough.
+void
+test_clip_info ()
+{
+  auto surf = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 100, 100);
+  auto cr = Cairo::Context::create(surf);
+  std::vector<Cairo::RectangleInt> rects = {{0, 0, 10, 10}, {20, 20, 10, 10}};
+  cr->clip(Cairo::Region::create(rects));
+
+  std::vector<Cairo::Rectangle> clip_rects;
+  cr->clip_rectangles_into(clip_rects);
+  const auto before = allocation_count;
+  for(int i = 0; i < ITERATIONS; ++i)
+  {
+    cr->get_clip_info();
+    cr->clip_rectangles_into(clip_rects);
+  }
+  const auto allocations = allocation_count - before;
+  BOOST_CHECK_EQUAL (0ul, allocations);
+}
+
+test_suite*
+init_unit_test_suite(int argc, char* argv[])
+{
+  // compile even with -Werror
+  if (argc && argv) {}
+
+  test_suite* test= BOOST_TEST_SUITE( "Allocation Count Tests" );
+
+  test->add (BOOST_TEST_CASE (&test_get_target));
+  test->add (BOOST_TEST_CASE (&test_get_source));
+  test->add (BOOST_TEST_CASE (&test_refptr_copy));
+  test->add (BOOST_TEST_CASE (&test_refptr_create));
+  test->add (BOOST_TEST_CASE (&test_text_to_glyphs));
+  test->add (BOOST_TEST_CASE (&test_user_font_callbacks));
+  test->add (BOOST_TEST_CASE (&test_region_rectangles));
+  test->add (BOOST_TEST_CASE (&test_clip_info));
+
+  return test;
+}
@@ -6,12 +6,17 @@
  * work generally
  */
 
+#include <array>
 #include <cfloat>
+#include <memory>
+#include <thread>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_tools.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 using namespace boost::unit_test;
 #include <cairomm/context.h>
+#include <cairomm/context_pool.h>
 #include <cairomm/scaledfont.h>
 
 #define CREATE_CONTEXT(varname) \
@@ -271,6 +276,24 @@ test_draw ()
   cr->paint ();
 }
 
+void
+test_unchecked ()
+{
+  CREATE_CONTEXT (cr);
+  auto u = cr->unchecked ();
+  u.move_to (1.0, 1.0);
+  u.line_to (2.0, 2.0);
+  u.rectangle (0.0, 0.0, 1.0, 1.0);
+  u.close_path ();
+  u.stroke ();
+  BOOST_CHECK_NO_THROW (cr->check ());
+
+  // the error is kept by the context until it is checked
+  u.restore ();
+  u.line_to (3.0, 3.0);
+  BOOST_CHECK_THROW (cr->check (), Cairo::logic_error);
+}
+
 void
 test_clip ()
 {
@@ -285,6 +308,82 @@ test_clip ()
   BOOST_CHECK (y2 == 1.0);
 }
 
+void
+test_clip_region ()
+{
+  CREATE_CONTEXT (cr);
+  std::vector<Cairo::RectangleInt> rects = {{1, 1, 2, 2}, {5, 5, 3, 3}};
+  auto region = Cairo::Region::create (rects);
+  cr->move_to (9.0, 9.0);
+  cr->clip (region);
+  BOOST_CHECK (!cr->has_current_point ());
+  BOOST_CHECK (cr->in_clip (1.5, 1.5));
+  BOOST_CHECK (cr->in_clip (6.5, 6.5));
+  BOOST_CHECK (!cr->in_clip (4.0, 4.0));
+
+  std::vector<Cairo::Rectangle> clip_rects;
+  cr->copy_clip_rectangle_list (clip_rects);
+  BOOST_CHECK_EQUAL (2u, clip_rects.size ());
+
+  // clip() only shrinks the clip, set_clip_region() replaces it
+  cr->clip (Cairo::Region::create (Cairo::RectangleInt{0, 0, 4, 4}));
+  BOOST_CHECK (!cr->in_clip (6.5, 6.5));
+  cr->set_clip_region (Cairo::Region::create (Cairo::RectangleInt{4, 4, 2, 2}));
+  BOOST_CHECK (cr->in_clip (4.5, 4.5));
+  BOOST_CHECK (!cr->in_clip (1.5, 1.5));
+
+  // an empty region clips everything away
+  cr->clip (Cairo::Region::create ());
+  BOOST_CHECK (!cr->in_clip (4.5, 4.5));
+}
+
+void
+test_clip_info ()
+{
+  CREATE_CONTEXT (cr);
+  std::vector<Cairo::RectangleInt> rects = {{1, 1, 2, 2}, {5, 5, 3, 3}};
+  cr->clip (Cairo::Region::create (rects));
+
+  auto info = cr->get_clip_info ();
+  BOOST_CHECK (info.rectangular);
+  BOOST_CHECK_EQUAL (2, info.n_rectangles);
+  BOOST_CHECK_EQUAL (1.0, info.x1);
+  BOOST_CHECK_EQUAL (8.0, info.x2);
+
+  std::vector<Cairo::Rectangle> clip_rects;
+  BOOST_CHECK (cr->clip_rectangles_into (clip_rects));
+  BOOST_CHECK_EQUAL (2u, clip_rects.size ());
+
+  auto region = cr->copy_clip_region ();
+  BOOST_CHECK_EQUAL (2, region->get_num_rectangles ());
+  BOOST_CHECK (region->contains_point (6, 6));
+  BOOST_CHECK (!region->contains_point (4, 4));
+
+  // half a pixel off, which cairo doesn't represent as rectangles, so the
+  // region covers the extents
+  cr->reset_clip ();
+  cr->rectangle (0.5, 0.5, 2.0, 2.0);
+  cr->clip ();
+  info = cr->get_clip_info ();
+  BOOST_CHECK (!info.rectangular);
+  BOOST_CHECK_EQUAL (0, info.n_rectangles);
+  BOOST_CHECK (!cr->clip_rectangles_into (clip_rects));
+  region = cr->copy_clip_region ();
+  BOOST_CHECK_EQUAL (Cairo::REGION_OVERLAP_IN,
+    region->contains_rectangle (Cairo::RectangleInt{0, 0, 3, 3}));
+
+  // a circle is not made of rectangles
+  cr->reset_clip ();
+  cr->arc (5.0, 5.0, 3.0, 0.0, 2 * M_PI);
+  cr->clip ();
+  info = cr->get_clip_info ();
+  BOOST_CHECK (!info.rectangular);
+  BOOST_CHECK (!cr->clip_rectangles_into (clip_rects));
+  BOOST_CHECK (clip_rects.empty ());
+  region = cr->copy_clip_region ();
+  BOOST_CHECK (region->contains_point (5, 5));
+}
+
 void
 test_current_point ()
 {
@@ -296,6 +395,175 @@ test_current_point ()
   BOOST_CHECK (y == 3.0);
 }
 
+void
+test_batched_path ()
+{
+  CREATE_CONTEXT (cr);
+  std::vector<double> xy = { 1.0, 1.0, 4.0, 1.0, 4.0, 5.0 };
+  cr->move_to_lines (xy);
+  double x, y;
+  cr->get_current_point (x, y);
+  BOOST_CHECK (x == 4.0);
+  BOOST_CHECK (y == 5.0);
+
+  const double more[] = { 6.0, 7.0, 8.0, 9.0 };
+  cr->polyline (more, 2);
+  cr->get_current_point (x, y);
+  BOOST_CHECK (x == 8.0);
+  BOOST_CHECK (y == 9.0);
+
+  cr->begin_new_path ();
+  cr->polygon (xy);
+  cr->get_current_point (x, y);
+  BOOST_CHECK (x == 1.0);
+  BOOST_CHECK (y == 1.0);
+
+  cr->begin_new_path ();
+  std::array<Cairo::Rectangle, 2> rects = { { { 0.0, 0.0, 1.0, 1.0 },
+                                              { 2.0, 3.0, 4.0, 5.0 } } };
+  cr->rectangles (rects);
+  double x1, y1, x2, y2;
+  cr->get_path_extents (x1, y1, x2, y2);
+  BOOST_CHECK (x1 == 0.0);
+  BOOST_CHECK (y1 == 0.0);
+  BOOST_CHECK (x2 == 6.0);
+  BOOST_CHECK (y2 == 8.0);
+}
+
+void
+test_path ()
+{
+  CREATE_CONTEXT (cr);
+  cr->move_to (1.0, 2.0);
+  cr->line_to (3.0, 4.0);
+  cr->curve_to (5.0, 6.0, 7.0, 8.0, 9.0, 10.0);
+  cr->close_path ();
+
+  std::unique_ptr<Cairo::Path> copied (cr->copy_path ());
+  Cairo::Path path (*copied);
+  copied.reset ();
+
+  std::vector<Cairo::PathDataType> types;
+  std::vector<double> points;
+  for (const auto& segment : path)
+  {
+    types.push_back (segment.get_type ());
+    for (int i = 0; i < segment.get_num_points (); ++i)
+    {
+      double x, y;
+      segment.get_point (i, x, y);
+      points.push_back (x);
+      points.push_back (y);
+    }
+  }
+
+  // cairo adds a move_to after close_path
+  BOOST_REQUIRE_EQUAL (types.size (), 5u);
+  BOOST_CHECK (types[0] == Cairo::PATH_MOVE_TO);
+  BOOST_CHECK (types[1] == Cairo::PATH_LINE_TO);
+  BOOST_CHECK (types[2] == Cairo::PATH_CURVE_TO);
+  BOOST_CHECK (types[3] == Cairo::PATH_CLOSE_PATH);
+  BOOST_CHECK (types[4] == Cairo::PATH_MOVE_TO);
+  // 1 + 1 + 3 + 0 + 1 points
+  BOOST_REQUIRE_EQUAL (points.size (), 12u);
+  BOOST_CHECK_EQUAL (points[0], 1.0);
+  BOOST_CHECK_EQUAL (points[9], 10.0);
+  BOOST_CHECK_EQUAL (points[11], 2.0);
+
+  Cairo::Path moved (std::move (path));
+  Cairo::Path assigned;
+  BOOST_CHECK (assigned.begin () == assigned.end ());
+  assigned = moved;
+
+  cr->begin_new_path ();
+  cr->append_path (assigned);
+  double x1, y1, x2, y2;
+  cr->get_path_extents (x1, y1, x2, y2);
+  BOOST_CHECK_EQUAL (x1, 1.0);
+  BOOST_CHECK_EQUAL (y1, 2.0);
+  BOOST_CHECK_EQUAL (x2, 9.0);
+  BOOST_CHECK_EQUAL (y2, 10.0);
+}
+
+void
+test_path_builder ()
+{
+  Cairo::PathBuilder builder;
+  builder.reserve (32);
+  builder.move_to (1.0, 2.0);
+  builder.line_to (3.0, 4.0);
+  builder.curve_to (5.0, 6.0, 7.0, 8.0, 9.0, 10.0);
+  builder.close_path ();
+  BOOST_CHECK_THROW (Cairo::PathBuilder ().rel_line_to (1.0, 1.0),
+                     Cairo::logic_error);
+
+  // the builder produces the same data as cairo
+  CREATE_CONTEXT (cr);
+  cr->append_path (builder.get_path ());
+  std::unique_ptr<Cairo::Path> copied (cr->copy_path ());
+  BOOST_REQUIRE_EQUAL (copied->cobj ()->num_data,
+                       static_cast<int> (builder.size ()));
+  auto built = builder.get_path ();
+  auto segment = built.begin ();
+  for (const auto& expected : *copied)
+  {
+    BOOST_REQUIRE (segment != built.end ());
+    BOOST_CHECK_EQUAL (segment->get_type (), expected.get_type ());
+    for (int i = 0; i < expected.get_num_points (); ++i)
+    {
+      double x1, y1, x2, y2;
+      segment->get_point (i, x1, y1);
+      expected.get_point (i, x2, y2);
+      BOOST_CHECK_EQUAL (x1, x2);
+      BOOST_CHECK_EQUAL (y1, y2);
+    }
+    ++segment;
+  }
+
+  // clearing keeps the buffer
+  const auto capacity = builder.capacity ();
+  builder.clear ();
+  BOOST_CHECK_EQUAL (builder.size (), 0u);
+  BOOST_CHECK_EQUAL (builder.capacity (), capacity);
+  BOOST_CHECK (!builder.has_current_point ());
+}
+
+void
+test_path_utilities ()
+{
+  Cairo::PathBuilder builder;
+  builder.move_to (0.0, 0.0);
+  builder.curve_to (0.0, 10.0, 10.0, 10.0, 10.0, 0.0);
+  builder.close_path ();
+  auto path = builder.get_path ();
+
+  // the bounds match cairo's path extents
+  CREATE_CONTEXT (cr);
+  cr->append_path (path);
+  double x1, y1, x2, y2;
+  double cx1, cy1, cx2, cy2;
+  path.get_extents (x1, y1, x2, y2);
+  cr->get_path_extents (cx1, cy1, cx2, cy2);
+  BOOST_CHECK_CLOSE (x2, cx2, 0.1);
+  BOOST_CHECK_CLOSE (y2, 7.5, 1e-9);
+  BOOST_CHECK_CLOSE (y2, cy2, 0.1);
+
+  auto flat = path.flatten (0.01);
+  for (const auto& segment : flat)
+    BOOST_CHECK (segment.get_type () != Cairo::PATH_CURVE_TO);
+  BOOST_CHECK_CLOSE (flat.get_length (), path.get_length (0.01), 0.1);
+
+  path.transform (Cairo::scaling_matrix (2.0, 3.0));
+  path.get_extents (x1, y1, x2, y2);
+  BOOST_CHECK_EQUAL (x1, 0.0);
+  BOOST_CHECK_EQUAL (x2, 20.0);
+  BOOST_CHECK_CLOSE (y2, 22.5, 1e-9);
+
+  Cairo::PathBuilder square;
+  square.rectangle (0.0, 0.0, 2.0, 3.0);
+  BOOST_CHECK_CLOSE (square.get_path ().get_length (), 10.0, 1e-9);
+}
+
 void
 test_target ()
 {
@@ -320,6 +588,25 @@ test_target ()
   BOOST_CHECK (!bad_surface2);
 }
 
+void
+test_wrapper_identity ()
+{
+  CREATE_CONTEXT (cr);
+  // the wrapper created by ImageSurface::create() is handed out again
+  BOOST_CHECK (cr->get_target () == surf);
+
+  auto solid_pattern = Cairo::SolidPattern::create_rgb (1.0, 0.5, 0.25);
+  cr->set_source (solid_pattern);
+  BOOST_CHECK (cr->get_source () == solid_pattern);
+
+  // a wrapper created by a getter is reused while somebody holds it
+  cr->set_source_rgb (0.25, 0.5, 1.0);
+  auto source = cr->get_source ();
+  BOOST_CHECK (source != solid_pattern);
+  BOOST_CHECK (cr->get_source () == source);
+  BOOST_CHECK (Cairo::dynamic_pointer_cast<Cairo::SolidPattern> (source));
+}
+
 void test_scaled_font()
 {
   CREATE_CONTEXT (cr);
@@ -353,6 +640,110 @@ void test_font_options()
   BOOST_CHECK(options == other);
 }
 
+void test_context_pool()
+{
+  Cairo::ContextPool pool;
+  auto surf = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 10, 10);
+  auto cr = pool.acquire(surf);
+  BOOST_REQUIRE (cr);
+  BOOST_CHECK (cr->get_target () == surf);
+  auto wrapper = cr.get ();
+
+  cr->translate (3, 4);
+  cr->set_source_rgb (1.0, 0.5, 0.25);
+  cr->set_line_width (7);
+  cr->rectangle (1, 1, 2, 2);
+  cr->clip_preserve ();
+  pool.release (cr);
+  BOOST_CHECK (!cr);
+
+  // the same context comes back, in its default state
+  cr = pool.acquire (surf);
+  BOOST_CHECK_EQUAL (wrapper, cr.get ());
+  Cairo::Matrix matrix;
+  cr->get_matrix (matrix);
+  BOOST_CHECK_EQUAL (1.0, matrix.xx);
+  BOOST_CHECK_EQUAL (0.0, matrix.x0);
+  BOOST_CHECK_EQUAL (0.0, matrix.y0);
+  double red = 0, green = 0, blue = 0, alpha = 0;
+  auto source = Cairo::dynamic_pointer_cast<Cairo::SolidPattern> (cr->get_source ());
+  BOOST_REQUIRE (source);
+  source->get_rgba (red, green, blue, alpha);
+  BOOST_CHECK_EQUAL (0.0, red);
+  BOOST_CHECK_EQUAL (1.0, alpha);
+  BOOST_CHECK_EQUAL (2.0, cr->get_line_width ());
+  BOOST_CHECK (!cr->has_current_point ());
+  double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+  cr->get_clip_extents (x1, y1, x2, y2);
+  BOOST_CHECK_EQUAL (0.0, x1);
+  BOOST_CHECK_EQUAL (10.0, x2);
+
+  // rebinding to another target keeps the wrapper
+  pool.release (cr);
+  auto other = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 20, 20);
+  cr = pool.acquire (other);
+  BOOST_CHECK_EQUAL (wrapper, cr.get ());
+  BOOST_CHECK (cr->get_target () == other);
+
+  // a context that is still referenced elsewhere is not reused
+  auto kept = cr;
+  pool.release (cr);
+  BOOST_CHECK_EQUAL (0u, pool.get_statistics ().size);
+
+  // neither is one that is left in a group
+  cr = pool.acquire (other);
+  cr->push_group ();
+  pool.release (cr);
+  BOOST_CHECK_EQUAL (0u, pool.get_statistics ().size);
+
+  auto statistics = pool.get_statistics ();
+  BOOST_CHECK_EQUAL (1u, statistics.hits);
+  BOOST_CHECK_EQUAL (1u, statistics.rebinds);
+  BOOST_CHECK_EQUAL (2u, statistics.misses);
+
+  cr = pool.acquire (surf);
+  pool.release (cr);
+  BOOST_CHECK_EQUAL (1u, pool.get_statistics ().size);
+  pool.clear ();
+  BOOST_CHECK_EQUAL (0u, pool.get_statistics ().size);
+}
+
+void test_context_pool_bounded()
+{
+  Cairo::ContextPool pool (2, 1);
+  auto surf = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, 10, 10);
+
+  // the least recently released context is evicted beyond the maximum
+  auto cr1 = pool.acquire (surf);
+  auto cr2 = pool.acquire (surf);
+  auto cr3 = pool.acquire (surf);
+  auto first = cr1.get ();
+  pool.release (cr1);
+  pool.release (cr2);
+  pool.release (cr3);
+  auto statistics = pool.get_statistics ();
+  BOOST_CHECK_EQUAL (2u, statistics.size);
+  BOOST_CHECK_EQUAL (1u, statistics.evictions);
+  auto cr = pool.acquire (surf);
+  BOOST_CHECK (cr.get () != first);
+  pool.release (cr);
+
+  // the contexts of a thread that has exited are reused by other threads
+  pool.clear ();
+  Cairo::Context* released_by_thread = nullptr;
+  std::thread thread ([&pool, &surf, &released_by_thread] ()
+    {
+      auto thread_cr = pool.acquire (surf);
+      released_by_thread = thread_cr.get ();
+      pool.release (thread_cr);
+    });
+  thread.join ();
+  BOOST_CHECK_EQUAL (1u, pool.get_statistics ().size);
+  cr = pool.acquire (surf);
+  BOOST_CHECK_EQUAL (released_by_thread, cr.get ());
+  BOOST_CHECK_EQUAL (0u, pool.get_statistics ().size);
+}
+
 test_suite*
 init_unit_test_suite(int argc, char* argv[])
 {
@@ -375,11 +766,21 @@ init_unit_test_suite(int argc, char* argv[])
   test->add (BOOST_TEST_CASE (&test_matrix));
   test->add (BOOST_TEST_CASE (&test_user_device));
   test->add (BOOST_TEST_CASE (&test_draw));
+  test->add (BOOST_TEST_CASE (&test_unchecked));
   test->add (BOOST_TEST_CASE (&test_clip));
+  test->add (BOOST_TEST_CASE (&test_clip_region));
+  test->add (BOOST_TEST_CASE (&test_clip_info));
   test->add (BOOST_TEST_CASE (&test_current_point));
+  test->add (BOOST_TEST_CASE (&test_batched_path));
+  test->add (BOOST_TEST_CASE (&test_path));
+  test->add (BOOST_TEST_CASE (&test_path_builder));
+  test->add (BOOST_TEST_CASE (&test_path_utilities));
   test->add (BOOST_TEST_CASE (&test_target));
+  test->add (BOOST_TEST_CASE (&test_wrapper_identity));
   test->add (BOOST_TEST_CASE (&test_scaled_font));
   test->add (BOOST_TEST_CASE (&test_font_options));
+  test->add (BOOST_TEST_CASE (&test_context_pool));
+  test->add (BOOST_TEST_CASE (&test_context_pool_bounded));
 
   return test;
 }
@@ -4,6 +4,8 @@
 using namespace boost::unit_test;
 
 #include <cairomm/matrix.h>
+#include <algorithm>
+#include <vector>
 
 // this is necessary for BOOST_CHECK_EQUAL, but there's no equivalent in the C
 // API, so I'm reluctant to include it in cairomm right now
@@ -107,6 +109,56 @@ void test_multiply()
   BOOST_CHECK_EQUAL(C, D);
 }
 
+void test_transform_points()
+{
+  Cairo::Matrix matrix(1.5, 0.3, -0.7, 2.25, 10.1, -3.3);
+  std::vector<double> xy;
+  for(int i = 0; i < 2 * 37; ++i)
+    xy.push_back(i * 0.37 - 11.1);
+
+  auto expected = xy;
+  for(std::size_t i = 0; i < expected.size(); i += 2)
+    matrix.transform_point(expected[i], expected[i + 1]);
+
+  // the same as transform_point(), also for an odd number of points, up to
+  // the rounding of fused multiply-adds
+  matrix.transform_points(xy.data(), xy.size() / 2);
+  for(std::size_t i = 0; i < xy.size(); ++i)
+    BOOST_CHECK_SMALL(expected[i] - xy[i], 1e-12);
+
+  std::vector<Cairo::Glyph> glyphs;
+  for(unsigned long i = 0; i < 5; ++i)
+    glyphs.push_back(Cairo::Glyph{i, i * 1.25, i * -0.5});
+  matrix.transform_glyphs(glyphs.data(), glyphs.size());
+  for(unsigned long i = 0; i < 5; ++i)
+  {
+    double x = i * 1.25, y = i * -0.5;
+    matrix.transform_point(x, y);
+    BOOST_CHECK_EQUAL(i, glyphs[i].index);
+    BOOST_CHECK_SMALL(x - glyphs[i].x, 1e-12);
+    BOOST_CHECK_SMALL(y - glyphs[i].y, 1e-12);
+  }
+}
+
+void test_transform_rectangles()
+{
+  // an exact quarter turn and a translation
+  Cairo::Matrix matrix(0, 2, -1, 0, 10, 0);
+  std::vector<Cairo::Rectangle> rects(100, Cairo::Rectangle{1, 2, 3, 4});
+  matrix.transform_rectangles(rects.data(), rects.size());
+
+  double x1 = 1, y1 = 2, x2 = 4, y2 = 6;
+  matrix.transform_point(x1, y1);
+  matrix.transform_point(x2, y2);
+  for(const auto& rect : rects)
+  {
+    BOOST_CHECK_EQUAL(std::min(x1, x2), rect.x);
+    BOOST_CHECK_EQUAL(std::min(y1, y2), rect.y);
+    BOOST_CHECK_EQUAL(std::max(x1, x2) - std::min(x1, x2), rect.width);
+    BOOST_CHECK_EQUAL(std::max(y1, y2) - std::min(y1, y2), rect.height);
+  }
+}
+
 test_suite*
 init_unit_test_suite(int /*argc*/, char** /*argv*/)
 {
@@ -116,6 +168,8 @@ init_unit_test_suite(int /*argc*/, char** /*argv*/)
   test->add (BOOST_TEST_CASE (&test_invert));
   test->add (BOOST_TEST_CASE (&test_cast));
   test->add (BOOST_TEST_CASE (&test_multiply));
+  test->add (BOOST_TEST_CASE (&test_transform_points));
+  test->add (BOOST_TEST_CASE (&test_transform_rectangles));
 
   return test;
 }
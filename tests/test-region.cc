@@ -0,0 +1,95 @@
+#include <array>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_tools.hpp>
+using namespace boost::unit_test;
+
+#include <cairomm/region.h>
+
+void test_create_from_rectangles()
+{
+  std::vector<Cairo::RectangleInt> rects = {{0, 0, 10, 10}, {20, 0, 10, 10}};
+  auto from_vector = Cairo::Region::create(rects);
+  BOOST_CHECK_EQUAL(2, from_vector->get_num_rectangles());
+
+  std::array<Cairo::RectangleInt, 2> array = {{{0, 0, 10, 10}, {5, 5, 10, 10}}};
+  auto from_array = Cairo::Region::create(array);
+  BOOST_CHECK(!from_array->empty());
+  BOOST_CHECK_EQUAL(Cairo::REGION_OVERLAP_IN,
+    from_array->contains_rectangle(Cairo::RectangleInt{5, 5, 10, 10}));
+
+  auto empty = Cairo::Region::create(std::vector<Cairo::RectangleInt>());
+  BOOST_CHECK(empty->empty());
+}
+
+void test_get_rectangles()
+{
+  std::vector<Cairo::RectangleInt> rects = {{0, 0, 10, 10}, {20, 0, 10, 10}, {0, 20, 30, 5}};
+  auto region = Cairo::Region::create(rects);
+
+  std::vector<Cairo::RectangleInt> result(10);
+  region->get_rectangles(result);
+  BOOST_REQUIRE_EQUAL(static_cast<std::size_t>(region->get_num_rectangles()), result.size());
+  for(int i = 0; i < region->get_num_rectangles(); ++i)
+  {
+    const auto expected = region->get_rectangle(i);
+    BOOST_CHECK_EQUAL(expected.x, result[i].x);
+    BOOST_CHECK_EQUAL(expected.y, result[i].y);
+    BOOST_CHECK_EQUAL(expected.width, result[i].width);
+    BOOST_CHECK_EQUAL(expected.height, result[i].height);
+  }
+
+  BOOST_CHECK_EQUAL(result.size(), region->get_rectangles().size());
+
+  Cairo::Region::create()->get_rectangles(result);
+  BOOST_CHECK(result.empty());
+}
+
+void test_rects_operations()
+{
+  std::vector<Cairo::RectangleInt> rects;
+  for(int i = 0; i < 200; ++i)
+    rects.push_back(Cairo::RectangleInt{(i * 37) % 500, (i * 53) % 300, 20 + i % 7, 15 + i % 5});
+
+  // the batched operations give the same result as one call per rectangle
+  auto base = Cairo::RectangleInt{100, 50, 300, 200};
+  auto batched = Cairo::Region::create(base);
+  auto one_by_one = Cairo::Region::create(base);
+  batched->union_rects(rects);
+  for(const auto& rect : rects)
+    one_by_one->do_union(rect);
+  BOOST_CHECK(cairo_region_equal(batched->cobj(), one_by_one->cobj()));
+
+  batched = Cairo::Region::create(base);
+  one_by_one = Cairo::Region::create(base);
+  batched->subtract_rects(rects);
+  for(const auto& rect : rects)
+    one_by_one->subtract(rect);
+  BOOST_CHECK(cairo_region_equal(batched->cobj(), one_by_one->cobj()));
+
+  batched = Cairo::Region::create(base);
+  batched->intersect_rects(rects);
+  one_by_one = Cairo::Region::create(rects);
+  one_by_one->intersect(base);
+  BOOST_CHECK(cairo_region_equal(batched->cobj(), one_by_one->cobj()));
+
+  // nothing to add or remove, but nothing to intersect with either
+  batched = Cairo::Region::create(base);
+  batched->union_rects(nullptr, 0);
+  batched->subtract_rects(nullptr, 0);
+  BOOST_CHECK_EQUAL(Cairo::REGION_OVERLAP_IN, batched->contains_rectangle(base));
+  batched->intersect_rects(nullptr, 0);
+  BOOST_CHECK(batched->empty());
+}
+
+test_suite*
+init_unit_test_suite(int /*argc*/, char** /*argv*/)
+{
+  test_suite* test= BOOST_TEST_SUITE( "Cairo::Region Tests" );
+
+  test->add (BOOST_TEST_CASE (&test_create_from_rectangles));
+  test->add (BOOST_TEST_CASE (&test_get_rectangles));
+  test->add (BOOST_TEST_CASE (&test_rects_operations));
+
+  return test;
+}
@@ -2,6 +2,7 @@
 #include <boost/test/test_tools.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 using namespace boost::unit_test;
+#include <cairomm/fontcache.h>
 #include <cairomm/scaledfont.h>
 #include <iostream>
 
@@ -37,6 +38,53 @@ void test_text_to_glyphs()
   BOOST_CHECK_EQUAL(3, clusters.size());
 }
 
+void test_glyph_run_cache()
+{
+  auto face = ToyFontFace::create("sans", FONT_SLANT_NORMAL, FONT_WEIGHT_NORMAL);
+  auto font = ScaledFont::create(face, scaling_matrix(10, 10), identity_matrix());
+  BOOST_CHECK_EQUAL(0, font->get_glyph_run_cache_size());
+
+  std::vector<Glyph> expected;
+  std::vector<TextCluster> expected_clusters;
+  TextClusterFlags expected_flags;
+  font->text_to_glyphs(10, 20, "foo", expected, expected_clusters, expected_flags);
+
+  font->set_glyph_run_cache_size(4096);
+  BOOST_CHECK_EQUAL(4096, font->get_glyph_run_cache_size());
+
+  // the first call fills the cache, the second one is translated from it
+  for (int i = 0; i < 2; ++i) {
+    std::vector<Glyph> glyphs;
+    std::vector<TextCluster> clusters;
+    TextClusterFlags flags;
+    font->text_to_glyphs(10, 20, "foo", glyphs, clusters, flags);
+    BOOST_REQUIRE_EQUAL(expected.size(), glyphs.size());
+    for (std::size_t j = 0; j < glyphs.size(); ++j) {
+      BOOST_CHECK_EQUAL(expected[j].index, glyphs[j].index);
+      BOOST_CHECK_CLOSE(expected[j].x, glyphs[j].x, 1e-9);
+      BOOST_CHECK_CLOSE(expected[j].y, glyphs[j].y, 1e-9);
+    }
+    BOOST_CHECK_EQUAL(expected_clusters.size(), clusters.size());
+    BOOST_CHECK_EQUAL(expected_flags, flags);
+  }
+
+  // the cache is shared by all wrappers of the same font
+  auto wrapper = make_refptr_for_instance<ScaledFont>(new ScaledFont(font->cobj()));
+  BOOST_CHECK_EQUAL(4096, wrapper->get_glyph_run_cache_size());
+
+  // strings that don't fit are converted without the cache
+  font->set_glyph_run_cache_size(1);
+  std::vector<Glyph> glyphs;
+  std::vector<TextCluster> clusters;
+  TextClusterFlags flags;
+  font->text_to_glyphs(0, 0, "foo", glyphs, clusters, flags);
+  BOOST_CHECK_EQUAL(3, glyphs.size());
+
+  font->clear_glyph_run_cache();
+  font->set_glyph_run_cache_size(0);
+  BOOST_CHECK_EQUAL(0, font->get_glyph_run_cache_size());
+}
+
 void test_scale_matrix()
 {
   auto face = ToyFontFace::create("sans", FONT_SLANT_NORMAL, FONT_WEIGHT_NORMAL);
@@ -103,6 +151,50 @@ void test_ft_scaled_font()
 }
 #endif // CAIRO_HAS_FT_FONT
 
+void test_font_cache()
+{
+  FontCache cache(2, 1);
+  auto font = cache.get_scaled_font("sans", FONT_SLANT_NORMAL, FONT_WEIGHT_NORMAL,
+                                    scaling_matrix(10, 10), identity_matrix());
+  BOOST_REQUIRE(font);
+  BOOST_CHECK_EQUAL(1, cache.get_statistics().misses);
+
+  // the same key gives the same font
+  auto same = cache.get_scaled_font("sans", FONT_SLANT_NORMAL, FONT_WEIGHT_NORMAL,
+                                    scaling_matrix(10, 10), identity_matrix());
+  BOOST_CHECK(font == same);
+  BOOST_CHECK_EQUAL(1, cache.get_statistics().hits);
+
+  // the translation of the ctm doesn't matter
+  auto translated = cache.get_scaled_font("sans", FONT_SLANT_NORMAL, FONT_WEIGHT_NORMAL,
+                                          scaling_matrix(10, 10), translation_matrix(3, 4));
+  auto other_offset = cache.get_scaled_font("sans", FONT_SLANT_NORMAL, FONT_WEIGHT_NORMAL,
+                                            scaling_matrix(10, 10), translation_matrix(-7, 11.5));
+  BOOST_CHECK(font == translated);
+  BOOST_CHECK(font == other_offset);
+  BOOST_CHECK_EQUAL(3, cache.get_statistics().hits);
+  BOOST_CHECK_EQUAL(1, cache.get_statistics().misses);
+
+  // the face is shared between sizes
+  auto bigger = cache.get_scaled_font("sans", FONT_SLANT_NORMAL, FONT_WEIGHT_NORMAL,
+                                      scaling_matrix(20, 20), identity_matrix());
+  BOOST_CHECK(font != bigger);
+  BOOST_CHECK_EQUAL(2, cache.get_statistics().misses);
+  auto face = cache.get_font_face("sans", FONT_SLANT_NORMAL, FONT_WEIGHT_NORMAL);
+  BOOST_CHECK_EQUAL(face->cobj(), font->get_font_face()->cobj());
+  BOOST_CHECK_EQUAL(face->cobj(), bigger->get_font_face()->cobj());
+
+  // a third font evicts the least recently used one
+  cache.get_scaled_font("sans", FONT_SLANT_ITALIC, FONT_WEIGHT_NORMAL,
+                        scaling_matrix(10, 10), identity_matrix());
+  BOOST_CHECK_EQUAL(1, cache.get_statistics().evictions);
+  BOOST_CHECK(font != cache.get_scaled_font("sans", FONT_SLANT_NORMAL, FONT_WEIGHT_NORMAL,
+                                            scaling_matrix(10, 10), identity_matrix()));
+
+  cache.clear();
+  BOOST_CHECK_EQUAL(0, cache.get_statistics().size);
+}
+
 
 test_suite*
 init_unit_test_suite(int argc, char* argv[])
@@ -114,11 +206,13 @@ init_unit_test_suite(int argc, char* argv[])
 
   test->add(BOOST_TEST_CASE(&test_construction));
   test->add(BOOST_TEST_CASE(&test_text_to_glyphs));
+  test->add(BOOST_TEST_CASE(&test_glyph_run_cache));
   test->add(BOOST_TEST_CASE(&test_scale_matrix));
   test->add(BOOST_TEST_CASE(&test_get_font_face));
 #ifdef CAIRO_HAS_FT_FONT
   test->add(BOOST_TEST_CASE(&test_ft_scaled_font));
 #endif // CAIRO_HAS_FT_FONT
+  test->add(BOOST_TEST_CASE(&test_font_cache));
 
   return test;
 }
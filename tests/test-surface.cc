@@ -1,9 +1,15 @@
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_tools.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 using namespace boost::unit_test;
 #include <cairomm/surface.h>
+#include <cairomm/context.h>
+#include <cairomm/image_surface_pool.h>
+#include <cairomm/tiled_surface.h>
 using namespace Cairo;
 
 static unsigned int test_slot_called = 0;
@@ -20,6 +26,87 @@ void test_write_to_png_stream()
   BOOST_CHECK(test_slot_called > 0);
 }
 
+static std::vector<unsigned char> test_slot_data;
+ErrorStatus test_collect_slot(const unsigned char* data, unsigned int len)
+{
+  test_slot_data.insert(test_slot_data.end(), data, data + len);
+  return CAIRO_STATUS_SUCCESS;
+}
+
+void test_write_to_png_buffer()
+{
+  auto surface = ImageSurface::create(FORMAT_ARGB32, 16, 16);
+  test_slot_data.clear();
+  surface->write_to_png_stream(sigc::ptr_fun(&test_collect_slot));
+
+  // the buffer is appended to
+  std::vector<unsigned char> buffer(1, 0x42);
+  surface->write_to_png_buffer(buffer);
+  BOOST_REQUIRE_EQUAL(buffer.size(), test_slot_data.size() + 1);
+  BOOST_CHECK_EQUAL(buffer[0], 0x42);
+  BOOST_CHECK(std::equal(test_slot_data.begin(), test_slot_data.end(),
+                         buffer.begin() + 1));
+
+  // a fixed buffer that is too small reports the size needed
+  std::vector<unsigned char> fixed(10);
+  std::size_t length = 0;
+  BOOST_CHECK(!surface->write_to_png_buffer(fixed.data(), fixed.size(), length));
+  BOOST_CHECK_EQUAL(length, test_slot_data.size());
+  BOOST_CHECK(std::equal(fixed.begin(), fixed.end(), test_slot_data.begin()));
+
+  fixed.resize(length);
+  BOOST_CHECK(surface->write_to_png_buffer(fixed.data(), fixed.size(), length));
+  BOOST_CHECK(fixed == test_slot_data);
+}
+
+void test_stream_callables()
+{
+  auto surface = ImageSurface::create(FORMAT_ARGB32, 8, 8);
+  std::vector<unsigned char> png;
+  surface->write_to_png_stream(
+    [&png](const unsigned char* data, unsigned int length)
+    {
+      png.insert(png.end(), data, data + length);
+      return CAIRO_STATUS_SUCCESS;
+    });
+  BOOST_CHECK(!png.empty());
+
+  size_t offset = 0;
+  auto read_back = ImageSurface::create_from_png_stream(
+    [&png, &offset](unsigned char* data, unsigned int length)
+    {
+      if (offset + length > png.size())
+        return CAIRO_STATUS_READ_ERROR;
+      std::copy(png.begin() + offset, png.begin() + offset + length, data);
+      offset += length;
+      return CAIRO_STATUS_SUCCESS;
+    });
+  BOOST_CHECK_EQUAL(read_back->get_width(), 8);
+
+  // a plain function and a non-const slot, as older code passes them
+  test_slot_called = 0;
+  surface->write_to_png_stream(test_slot);
+  BOOST_CHECK(test_slot_called > 0);
+  Surface::SlotWriteFunc slot = sigc::ptr_fun(&test_slot);
+  test_slot_called = 0;
+  surface->write_to_png_stream(slot);
+  BOOST_CHECK(test_slot_called > 0);
+
+  // the callable is owned by the surface until it is destroyed
+  size_t written = 0;
+  {
+    auto pdf = PdfSurface::create_for_stream(
+      [&written](const unsigned char*, unsigned int length)
+      {
+        written += length;
+        return CAIRO_STATUS_SUCCESS;
+      }, 1, 1);
+    pdf->show_page();
+    pdf->finish();
+  }
+  BOOST_CHECK(written > 0);
+}
+
 void test_pdf_constructor_slot()
 {
   test_slot_called = nullptr;
@@ -82,6 +169,29 @@ void test_create_from_png()
   BOOST_CHECK(c_test_read_func_called > 0);
 }
 
+void test_create_from_png_memory()
+{
+  auto from_file = ImageSurface::create_from_png(PNG_STREAM_FILE);
+  auto mapped = ImageSurface::create_from_png_file_mmap(PNG_STREAM_FILE);
+  BOOST_REQUIRE_EQUAL(mapped->get_width(), from_file->get_width());
+  BOOST_REQUIRE_EQUAL(mapped->get_height(), from_file->get_height());
+  BOOST_REQUIRE_EQUAL(mapped->get_stride(), from_file->get_stride());
+  const auto size = from_file->get_stride() * from_file->get_height();
+  BOOST_CHECK(std::equal(from_file->get_data(), from_file->get_data() + size,
+                         mapped->get_data()));
+
+  std::vector<unsigned char> png;
+  from_file->write_to_png_buffer(png);
+  auto from_memory = ImageSurface::create_from_png_memory(png.data(), png.size());
+  BOOST_CHECK_EQUAL(from_memory->get_width(), from_file->get_width());
+
+  // truncated data and missing files are errors
+  BOOST_CHECK_THROW(ImageSurface::create_from_png_memory(png.data(), png.size() / 2),
+                    std::exception);
+  BOOST_CHECK_THROW(ImageSurface::create_from_png_file_mmap("does-not-exist.png"),
+                    std::exception);
+}
+
 void test_ps_eps()
 {
   auto ps = PsSurface::create("test.ps", 1, 1);
@@ -124,6 +234,98 @@ void test_show_text_glyphs()
   BOOST_CHECK(surf->has_show_text_glyphs());
 }
 
+void test_tiled_surface()
+{
+  auto image = ImageSurface::create(FORMAT_ARGB32, 100, 70);
+  TiledSurface tiles(image, 32, 32);
+  BOOST_CHECK_EQUAL(tiles.get_num_columns(), 4);
+  BOOST_CHECK_EQUAL(tiles.get_num_rows(), 3);
+  BOOST_CHECK(!tiles.is_dirty());
+  BOOST_CHECK(tiles.get_dirty_tiles().empty());
+
+  // the edge tiles are clipped to the surface
+  auto corner = tiles.get_tile(3, 2);
+  BOOST_CHECK_EQUAL(corner.rectangle.width, 4);
+  BOOST_CHECK_EQUAL(corner.rectangle.height, 6);
+
+  // a change crossing a tile boundary dirties both tiles, once each
+  tiles.invalidate(RectangleInt{30, 5, 4, 4});
+  tiles.invalidate(RectangleInt{31, 6, 2, 2});
+  // clipped to the surface, this lies inside the corner tile
+  tiles.invalidate(RectangleInt{96, 64, 50, 50});
+  auto dirty = tiles.get_dirty_tiles();
+  BOOST_REQUIRE_EQUAL(dirty.size(), 3u);
+  BOOST_CHECK_EQUAL(dirty[0].column, 0);
+  BOOST_CHECK_EQUAL(dirty[1].column, 1);
+  BOOST_CHECK_EQUAL(dirty[1].row, 0);
+  BOOST_CHECK_EQUAL(dirty[2].column, 3);
+  BOOST_CHECK_EQUAL(dirty[2].row, 2);
+
+  // only the dirty tiles are drawn, and only inside them
+  auto dirty_region = tiles.get_dirty_region();
+  int n_drawn = 0;
+  tiles.redraw([&n_drawn](const RefPtr<Context>& cr, const TiledSurface::Tile&)
+  {
+    ++n_drawn;
+    cr->set_source_rgb(1.0, 1.0, 1.0);
+    cr->paint();
+  });
+  BOOST_CHECK_EQUAL(n_drawn, 3);
+  BOOST_CHECK(!tiles.is_dirty());
+  BOOST_CHECK(dirty_region->empty());
+
+  tiles.invalidate_all();
+  BOOST_CHECK(!dirty_region->empty());
+  tiles.mark_all_clean();
+  BOOST_CHECK(dirty_region->empty());
+
+  image->flush();
+  auto pixel = [&image](int x, int y)
+  {
+    return *reinterpret_cast<const uint32_t*>(image->get_data() +
+                                              y * image->get_stride() + x * 4);
+  };
+  BOOST_CHECK_EQUAL(pixel(0, 0), 0xffffffffu);
+  BOOST_CHECK_EQUAL(pixel(63, 31), 0xffffffffu);
+  BOOST_CHECK_EQUAL(pixel(64, 0), 0u);
+  BOOST_CHECK_EQUAL(pixel(99, 69), 0xffffffffu);
+  BOOST_CHECK_EQUAL(pixel(95, 69), 0u);
+  BOOST_CHECK_EQUAL(pixel(0, 32), 0u);
+}
+
+void test_image_surface_pool()
+{
+  ImageSurfacePool pool(1024 * 1024);
+  unsigned char* first_data = nullptr;
+  {
+    auto surface = pool.create(FORMAT_ARGB32, 100, 100);
+    BOOST_CHECK_EQUAL(surface->get_width(), 100);
+    BOOST_CHECK_EQUAL(surface->get_stride() % 64, 0);
+    first_data = surface->get_data();
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(first_data) % 64, 0u);
+    first_data[0] = 0xff;
+    BOOST_CHECK(pool.get_statistics().bytes_in_use > 0);
+  }
+
+  auto statistics = pool.get_statistics();
+  BOOST_CHECK_EQUAL(statistics.misses, 1u);
+  BOOST_CHECK_EQUAL(statistics.bytes_in_use, 0u);
+  BOOST_CHECK(statistics.bytes_retained > 0);
+
+  // a surface of a similar size reuses the buffer, cleared
+  auto surface = pool.create(FORMAT_ARGB32, 100, 99);
+  BOOST_CHECK(surface->get_data() == first_data);
+  BOOST_CHECK_EQUAL(surface->get_data()[0], 0);
+  statistics = pool.get_statistics();
+  BOOST_CHECK_EQUAL(statistics.hits, 1u);
+  BOOST_CHECK_EQUAL(statistics.bytes_retained, 0u);
+
+  // buffers beyond the limit are freed
+  auto big = pool.create(FORMAT_ARGB32, 1000, 1000);
+  big.reset();
+  BOOST_CHECK_EQUAL(pool.get_statistics().bytes_retained, 0u);
+}
+
 
 test_suite*
 init_unit_test_suite(int argc, char* argv[])
@@ -134,13 +336,18 @@ init_unit_test_suite(int argc, char* argv[])
   test_suite* test= BOOST_TEST_SUITE( "Cairo::Surface Tests" );
 
   test->add (BOOST_TEST_CASE (&test_write_to_png_stream));
+  test->add (BOOST_TEST_CASE (&test_write_to_png_buffer));
+  test->add (BOOST_TEST_CASE (&test_stream_callables));
   test->add (BOOST_TEST_CASE (&test_pdf_constructor_slot));
   test->add (BOOST_TEST_CASE (&test_ps_constructor_slot));
   test->add (BOOST_TEST_CASE (&test_svg_constructor_slot));
   test->add (BOOST_TEST_CASE (&test_create_from_png));
+  test->add (BOOST_TEST_CASE (&test_create_from_png_memory));
   test->add (BOOST_TEST_CASE (&test_ps_eps));
   test->add (BOOST_TEST_CASE (&test_content));
   test->add (BOOST_TEST_CASE (&test_show_text_glyphs));
+  test->add (BOOST_TEST_CASE (&test_tiled_surface));
+  test->add (BOOST_TEST_CASE (&test_image_surface_pool));
 
   return test;
 }
@@ -7,6 +7,7 @@
  */
 
 #include <cfloat>
+#include <cstdint>
 #include <stdexcept>
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_tools.hpp>
@@ -176,6 +177,57 @@ void test_implement_neither()
   BOOST_REQUIRE(font->count_render_glyph > 0);
 }
 
+/******************************
+ * test_implement_partial_text
+ ******************************/
+// text_to_glyphs() only handles "x" and leaves other strings to
+// unicode_to_glyph()
+class ImplPartialTextUserFont: public NullRenderUserFont
+{
+public:
+  static RefPtr<ImplPartialTextUserFont> create() { return make_refptr_for_instance<ImplPartialTextUserFont>(new ImplPartialTextUserFont());};
+  ErrorStatus text_to_glyphs(const RefPtr<ScaledFont>& scaled_font,
+                                     const std::string& utf8,
+                                     std::vector<Glyph>& glyphs,
+                                     std::vector<TextCluster>& clusters,
+                                     TextClusterFlags& cluster_flags) override
+  {
+    if (utf8 != "x")
+      return UserFontFace::text_to_glyphs(scaled_font, utf8, glyphs, clusters, cluster_flags);
+
+    ++count_text_to_glyphs;
+    Glyph g = {84, 0, 0};
+    glyphs.push_back(g);
+    return CAIRO_STATUS_SUCCESS;
+  }
+  ErrorStatus unicode_to_glyph(const RefPtr<ScaledFont>& /*scaled_font*/,
+                                       unsigned long unicode,
+                                       unsigned long& glyph) override
+  { ++count_unicode_to_glyph; glyph = unicode; return CAIRO_STATUS_SUCCESS;}
+  int count_text_to_glyphs;
+  int count_unicode_to_glyph;
+
+protected:
+  ImplPartialTextUserFont() : NullRenderUserFont(), count_text_to_glyphs(0),
+  count_unicode_to_glyph(0) {}
+};
+
+void test_implement_partial_text()
+{
+  TestSetup setup;
+  auto font = ImplPartialTextUserFont::create();
+  setup.cr->set_font_face(font);
+  setup.cr->show_text("hello");
+  BOOST_REQUIRE(font->count_unicode_to_glyph > 0);
+  BOOST_REQUIRE_EQUAL(0, font->count_text_to_glyphs);
+
+  // falling back for "hello" must not affect later strings
+  const auto count_unicode_to_glyph = font->count_unicode_to_glyph;
+  setup.cr->show_text("x");
+  BOOST_REQUIRE_EQUAL(1, font->count_text_to_glyphs);
+  BOOST_REQUIRE_EQUAL(count_unicode_to_glyph, font->count_unicode_to_glyph);
+}
+
 /******************************
  * test_implement_init
  ******************************/
@@ -314,6 +366,145 @@ void test_user_font_exception()
 }
 
 
+/******************************
+ * test_callback_wrappers
+ ******************************/
+class WrapperUserFont : public UserFontFace
+{
+public:
+  static RefPtr<WrapperUserFont> create() { return make_refptr_for_instance<WrapperUserFont>(new WrapperUserFont());};
+
+  ErrorStatus
+  render_glyph(const RefPtr<ScaledFont>& scaled_font,
+               unsigned long /*glyph*/,
+               const RefPtr<Context>& cr,
+               TextExtents& /*metrics*/) override
+  {
+    ++count_render_glyph;
+    if (!first_scaled_font)
+      first_scaled_font = scaled_font.get();
+    else if (first_scaled_font != scaled_font.get())
+      same_scaled_font = false;
+
+    // keep the first Context, to check that it stays usable
+    if (!kept_cr)
+    {
+      kept_cr = cr;
+      kept_cr->set_line_width(3.0);
+    }
+    else
+      cr->set_line_width(1.0);
+    return CAIRO_STATUS_SUCCESS;
+  }
+
+  int count_render_glyph;
+  const ScaledFont* first_scaled_font;
+  bool same_scaled_font;
+  RefPtr<Context> kept_cr;
+
+protected:
+  WrapperUserFont() : UserFontFace(), count_render_glyph(0),
+  first_scaled_font(nullptr), same_scaled_font(true) {}
+};
+
+void test_callback_wrappers()
+{
+  auto font = WrapperUserFont::create();
+  {
+    TestSetup setup;
+    setup.cr->set_font_face(font);
+    setup.cr->show_text("hello");
+  }
+  BOOST_CHECK(font->count_render_glyph > 1);
+
+  // all glyphs of the scaled font are rendered with the same wrapper
+  BOOST_CHECK(font->same_scaled_font);
+
+  // the Context kept by the callback was not reused for the other glyphs
+  BOOST_REQUIRE(font->kept_cr);
+  BOOST_CHECK_EQUAL(3.0, font->kept_cr->get_line_width());
+  font->kept_cr.reset();
+}
+
+/******************************
+ * test_glyph_atlas
+ ******************************/
+class AtlasUserFont : public UserFontFace
+{
+public:
+  static RefPtr<AtlasUserFont> create() { return make_refptr_for_instance<AtlasUserFont>(new AtlasUserFont());};
+
+  ErrorStatus
+  render_glyph(const RefPtr<ScaledFont>& /*scaled_font*/,
+               unsigned long /*glyph*/,
+               const RefPtr<Context>& cr,
+               TextExtents& metrics) override
+  {
+    ++count_render_glyph;
+    Matrix font_matrix;
+    cr->get_font_matrix(font_matrix);
+    font_size = font_matrix.xx;
+    FontOptions options;
+    cr->get_font_options(options);
+    hint_metrics = options.get_hint_metrics();
+    cr->rectangle(0.0, -0.5, 0.5, 0.5);
+    cr->fill();
+    metrics.x_advance = 0.6;
+    return CAIRO_STATUS_SUCCESS;
+  }
+
+  int count_render_glyph;
+  // what the last call to render_glyph() found in its context
+  double font_size;
+  HintMetrics hint_metrics;
+
+protected:
+  AtlasUserFont() : UserFontFace(), count_render_glyph(0), font_size(0),
+    hint_metrics(HINT_METRICS_DEFAULT) {}
+};
+
+// draws "a" at (10, 50) with a size of 20, so the glyph covers (10, 40) to
+// (20, 50), and returns the pixel in the middle of it
+static uint32_t draw_with_atlas_font(const RefPtr<AtlasUserFont>& font,
+                                     HintMetrics hint_metrics)
+{
+  auto surface = ImageSurface::create(Cairo::FORMAT_ARGB32, 100, 100);
+  auto cr = Cairo::Context::create(surface);
+  cr->set_font_face(font);
+  cr->set_font_size(20);
+  FontOptions options;
+  options.set_hint_metrics(hint_metrics);
+  cr->set_font_options(options);
+  cr->move_to(10, 50);
+  cr->show_text("aab");
+  surface->flush();
+  return *reinterpret_cast<const uint32_t*>(surface->get_data() + 45 * surface->get_stride() + 15 * 4);
+}
+
+void test_glyph_atlas()
+{
+  auto font = AtlasUserFont::create();
+  BOOST_CHECK(!font->get_glyph_atlas_enabled());
+  BOOST_CHECK_THROW(font->enable_glyph_atlas(0, 256), Cairo::logic_error);
+  font->enable_glyph_atlas(256, 256, 2);
+  BOOST_CHECK(font->get_glyph_atlas_enabled());
+
+  BOOST_CHECK(draw_with_atlas_font(font, HINT_METRICS_ON) != 0);
+  const auto count = font->count_render_glyph;
+  BOOST_CHECK(count > 0);
+  // the context is set up like the one cairo passes without the atlas
+  BOOST_CHECK_EQUAL(1.0, font->font_size);
+  BOOST_CHECK_EQUAL(HINT_METRICS_ON, font->hint_metrics);
+
+  // other font options give another scaled font, but the same scale, so the
+  // glyphs come from the atlas
+  BOOST_CHECK(draw_with_atlas_font(font, HINT_METRICS_OFF) != 0);
+  BOOST_CHECK_EQUAL(count, font->count_render_glyph);
+
+  font->disable_glyph_atlas();
+  BOOST_CHECK(!font->get_glyph_atlas_enabled());
+}
+
 test_suite*
 init_unit_test_suite(int argc, char* argv[])
 {
@@ -326,8 +517,11 @@ init_unit_test_suite(int argc, char* argv[])
   test->add (BOOST_TEST_CASE (&test_implement_unicode));
   test->add (BOOST_TEST_CASE (&test_implement_both));
   test->add (BOOST_TEST_CASE (&test_implement_neither));
+  test->add (BOOST_TEST_CASE (&test_implement_partial_text));
   test->add (BOOST_TEST_CASE (&test_implement_init));
   test->add (BOOST_TEST_CASE (&test_user_font_exception));
+  test->add (BOOST_TEST_CASE (&test_callback_wrappers));
+  test->add (BOOST_TEST_CASE (&test_glyph_atlas));
 
   return test;
 }